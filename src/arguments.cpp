@@ -7,7 +7,24 @@ enum Option {
     OPTION_OUTPUT,
     OPTION_WIDTH,
     OPTION_HEIGHT,
-    OPTION_INI
+    OPTION_INI,
+    OPTION_FPS,
+    OPTION_UNFOCUSED_FPS,
+    OPTION_TIME,
+    OPTION_FIXED_TIMESTEP,
+    OPTION_PAUSED,
+    OPTION_MEMORY_BUDGET,
+    OPTION_TIMINGS,
+    OPTION_PIPELINE_STATS,
+    OPTION_CACHE_DIR,
+    OPTION_NO_CACHE,
+    OPTION_COMPILER_THREADS,
+    OPTION_VALIDATE,
+    OPTION_PLAYLIST,
+    OPTION_PLAYLIST_INTERVAL,
+    OPTION_STRIP_UNUSED,
+    OPTION_TEXTURE_CACHE,
+    OPTION_UPLOAD_BUDGET
 };
 
 static const getopt_option_t option_list[] = {
@@ -16,6 +33,23 @@ static const getopt_option_t option_list[] = {
     { "width",  'w', GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_WIDTH,  "viewport width, in pixels (default 800)" },
     { "height", 'h', GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_HEIGHT, "viewport height, in pixels (default 600)" },
     { "ini",      0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_INI, "Whether to enable ini shader file to save GUI presets (default true)" },
+    { "fps",      0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_FPS, "maximum frame rate when continuously rendering, 0 for no limit (default 0)" },
+    { "unfocused-fps", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_UNFOCUSED_FPS, "maximum frame rate when the window is not focused, 0 for no limit (default 10)" },
+    { "time",     't', GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_TIME, "value of the time uniform on the first frame, in seconds (default 0)" },
+    { "fixed-timestep", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_FIXED_TIMESTEP, "advance time by a fixed amount each frame instead of the wall clock, in seconds (default 0, disabled)" },
+    { "paused",   0, GETOPT_OPTION_TYPE_NO_ARG, 0, OPTION_PAUSED, "start with the clock paused" },
+    { "memory-budget", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_MEMORY_BUDGET, "GPU memory budget for textures and buffers, in megabytes, 0 for no budget (default 0)" },
+    { "timings",  0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_TIMINGS, "export GPU pass timings on exit", "CSV or JSON file" },
+    { "pipeline-stats", 0, GETOPT_OPTION_TYPE_NO_ARG, 0, OPTION_PIPELINE_STATS, "count samples passed and fragment invocations for each pass" },
+    { "cache-dir", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_CACHE_DIR, "directory for cached program binaries and decoded textures (default ~/.cache/live-glsl)", "directory" },
+    { "no-cache", 0, GETOPT_OPTION_TYPE_NO_ARG, 0, OPTION_NO_CACHE, "always compile programs and decode textures from source" },
+    { "compiler-threads", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_COMPILER_THREADS, "driver threads for parallel shader compilation, 0 to disable (default driver maximum)" },
+    { "validate", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_VALIDATE, "compile every shader of a directory without opening a window, and print a JSON report", "directory" },
+    { "playlist", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_PLAYLIST, "shaders to switch between with page up and page down, preloaded in the background", "directory or list file" },
+    { "playlist-interval", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_PLAYLIST_INTERVAL, "switch to the next playlist shader every interval, in seconds (default 0, disabled)" },
+    { "strip-unused", 0, GETOPT_OPTION_TYPE_NO_ARG, 0, OPTION_STRIP_UNUSED, "remove the functions and constants main does not use before compiling" },
+    { "texture-cache", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_TEXTURE_CACHE, "memory kept for decoded textures no shader uses anymore, in megabytes (default 256)" },
+    { "upload-budget", 0, GETOPT_OPTION_TYPE_REQUIRED, 0, OPTION_UPLOAD_BUDGET, "texture data streamed to the GPU each frame, in megabytes, 0 for no limit (default 16)" },
     GETOPT_OPTIONS_END
 };
 
@@ -53,11 +87,62 @@ bool ArgumentsParse(int argc, const char** argv, Arguments& args) {
             case OPTION_INI:
                 args.EnableIni = (bool)atoi(ctx.current_opt_arg);
                 break;
+            case OPTION_FPS:
+                args.MaxFPS = atoi(ctx.current_opt_arg);
+                break;
+            case OPTION_UNFOCUSED_FPS:
+                args.UnfocusedFPS = atoi(ctx.current_opt_arg);
+                break;
+            case OPTION_TIME:
+                args.StartTime = atof(ctx.current_opt_arg);
+                break;
+            case OPTION_FIXED_TIMESTEP:
+                args.FixedTimestep = atof(ctx.current_opt_arg);
+                break;
+            case OPTION_PAUSED:
+                args.StartPaused = true;
+                break;
+            case OPTION_MEMORY_BUDGET:
+                args.MemoryBudgetMB = atoi(ctx.current_opt_arg);
+                break;
+            case OPTION_TIMINGS:
+                args.TimingsOutput = ctx.current_opt_arg;
+                break;
+            case OPTION_PIPELINE_STATS:
+                args.PipelineStatistics = true;
+                break;
+            case OPTION_CACHE_DIR:
+                args.CacheDirectory = ctx.current_opt_arg;
+                break;
+            case OPTION_NO_CACHE:
+                args.EnableCache = false;
+                break;
+            case OPTION_COMPILER_THREADS:
+                args.CompilerThreads = atoi(ctx.current_opt_arg);
+                break;
+            case OPTION_VALIDATE:
+                args.ValidateDirectory = ctx.current_opt_arg;
+                break;
+            case OPTION_PLAYLIST:
+                args.Playlist = ctx.current_opt_arg;
+                break;
+            case OPTION_PLAYLIST_INTERVAL:
+                args.PlaylistInterval = atof(ctx.current_opt_arg);
+                break;
+            case OPTION_STRIP_UNUSED:
+                args.StripUnused = true;
+                break;
+            case OPTION_TEXTURE_CACHE:
+                args.TextureCacheMB = atoi(ctx.current_opt_arg);
+                break;
+            case OPTION_UPLOAD_BUDGET:
+                args.UploadBudgetMB = atoi(ctx.current_opt_arg);
+                break;
             default:
                 break;
         }
     }
-    if (args.Input.empty()) {
+    if (args.Input.empty() && args.ValidateDirectory.empty() && args.Playlist.empty()) {
         printf("live-glsl: no input file (--input [path])\n");
         return false;
     }
@@ -6,9 +6,26 @@
 struct Arguments {
     std::string Input;
     std::string Output;
+    std::string TimingsOutput;
     uint32_t Width {800};
     uint32_t Height {600};
     bool EnableIni {true};
+    uint32_t MaxFPS {0};
+    uint32_t UnfocusedFPS {10};
+    float StartTime {0.0f};
+    float FixedTimestep {0.0f};
+    bool StartPaused {false};
+    uint32_t MemoryBudgetMB {0};
+    bool PipelineStatistics {false};
+    std::string CacheDirectory;
+    bool EnableCache {true};
+    int32_t CompilerThreads {-1};
+    std::string ValidateDirectory;
+    std::string Playlist;
+    float PlaylistInterval {0.0f};
+    bool StripUnused {false};
+    uint32_t TextureCacheMB {256};
+    uint32_t UploadBudgetMB {16};
 };
 
 bool ArgumentsParse(int argc, const char** argv, Arguments& args);
@@ -0,0 +1,53 @@
+#include "frameclock.h"
+
+// Used when single stepping a clock that follows the wall time
+static const double DefaultStepTimestep = 1.0 / 60.0;
+
+void FrameClockReset(FrameClock& clock, double wall_time, double start_time) {
+    clock.Time = start_time;
+    clock.DeltaTime = 0.0;
+    clock.LastWallTime = wall_time;
+    clock.FrameIndex = 0;
+    clock.StepRequested = false;
+}
+
+void FrameClockTick(FrameClock& clock, double wall_time) {
+    double elapsed = wall_time - clock.LastWallTime;
+    clock.LastWallTime = wall_time;
+    clock.DeltaTime = 0.0;
+
+    // The first frame is always rendered at the start time
+    if (clock.FrameIndex++ == 0) {
+        return;
+    }
+
+    if (clock.IsPaused) {
+        if (clock.StepRequested) {
+            clock.DeltaTime = clock.FixedTimestep > 0.0 ? clock.FixedTimestep : DefaultStepTimestep;
+        }
+    } else {
+        clock.DeltaTime = clock.FixedTimestep > 0.0 ? clock.FixedTimestep : elapsed;
+    }
+
+    clock.Time += clock.DeltaTime;
+    clock.StepRequested = false;
+}
+
+void FrameClockSetPaused(FrameClock& clock, bool paused) {
+    clock.IsPaused = paused;
+    clock.StepRequested = false;
+}
+
+void FrameClockStep(FrameClock& clock) {
+    clock.IsPaused = true;
+    clock.StepRequested = true;
+}
+
+void FrameClockSeek(FrameClock& clock, double time) {
+    clock.Time = time < 0.0 ? 0.0 : time;
+    clock.DeltaTime = 0.0;
+}
+
+bool FrameClockIsAdvancing(const FrameClock& clock) {
+    return !clock.IsPaused || clock.StepRequested;
+}
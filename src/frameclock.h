@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+struct FrameClock {
+    double Time {0.0};
+    double DeltaTime {0.0};
+    double FixedTimestep {0.0};
+    double LastWallTime {0.0};
+    uint64_t FrameIndex {0};
+    bool IsPaused {false};
+    bool StepRequested {false};
+};
+
+void FrameClockReset(FrameClock& clock, double wall_time, double start_time);
+void FrameClockTick(FrameClock& clock, double wall_time);
+void FrameClockSetPaused(FrameClock& clock, bool paused);
+void FrameClockStep(FrameClock& clock);
+void FrameClockSeek(FrameClock& clock, double time);
+bool FrameClockIsAdvancing(const FrameClock& clock);
@@ -0,0 +1,82 @@
+#include "glextensions.h"
+
+#include <string.h>
+
+PFNGLGETQUERYOBJECTUI64VPROC glad_glGetQueryObjectui64v = nullptr;
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = nullptr;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = nullptr;
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = nullptr;
+
+static GLExtensions Extensions;
+
+static bool IsVersionAtLeast(int major, int minor) {
+    return Extensions.MajorVersion > major || (Extensions.MajorVersion == major && Extensions.MinorVersion >= minor);
+}
+
+bool GLExtensionsHas(const char* name) {
+    GLint extension_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+
+    for (GLint i = 0; i < extension_count; ++i) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void GLExtensionsLoad(GLADloadfunc load) {
+    Extensions = GLExtensions();
+
+    glGetIntegerv(GL_MAJOR_VERSION, &Extensions.MajorVersion);
+    glGetIntegerv(GL_MINOR_VERSION, &Extensions.MinorVersion);
+
+    if (IsVersionAtLeast(3, 3) || GLExtensionsHas("GL_ARB_timer_query")) {
+        glad_glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)load("glGetQueryObjectui64v");
+        Extensions.TimerQuery = glad_glGetQueryObjectui64v != nullptr;
+    }
+
+    Extensions.PipelineStatisticsQuery = IsVersionAtLeast(4, 6) || GLExtensionsHas("GL_ARB_pipeline_statistics_query");
+    Extensions.TextureSwizzle = IsVersionAtLeast(3, 3) || GLExtensionsHas("GL_ARB_texture_swizzle");
+    Extensions.TextureCompressionS3TC = GLExtensionsHas("GL_EXT_texture_compression_s3tc");
+
+    if (IsVersionAtLeast(4, 4) || GLExtensionsHas("GL_ARB_buffer_storage")) {
+        glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+        Extensions.BufferStorage = glad_glBufferStorage != nullptr;
+    }
+
+    if (IsVersionAtLeast(4, 1) || GLExtensionsHas("GL_ARB_get_program_binary")) {
+        glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+        glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+        glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+
+        // Drivers may expose the entry points without supporting a single binary format
+        GLint format_count = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+
+        Extensions.ProgramBinary = glad_glGetProgramBinary && glad_glProgramBinary && glad_glProgramParameteri && format_count > 0;
+    }
+
+    if (GLExtensionsHas("GL_KHR_parallel_shader_compile")) {
+        glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+    } else if (GLExtensionsHas("GL_ARB_parallel_shader_compile")) {
+        glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+    }
+    Extensions.ParallelShaderCompile = glad_glMaxShaderCompilerThreadsKHR != nullptr;
+}
+
+const GLExtensions& GLExtensionsGet() {
+    return Extensions;
+}
+
+void GLExtensionsSetCompilerThreads(int32_t threads) {
+    if (!Extensions.ParallelShaderCompile) {
+        return;
+    }
+
+    glMaxShaderCompilerThreadsKHR(threads < 0 ? 0xFFFFFFFF : (GLuint)threads);
+}
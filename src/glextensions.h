@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <stdint.h>
+
+// The glad loader only covers core OpenGL 3.2, newer entry points and
+// extensions used by the tool are declared and loaded here.
+
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+
+#ifndef GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+#define GL_FRAGMENT_SHADER_INVOCATIONS_ARB 0x82F4
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#ifndef GL_TEXTURE_SWIZZLE_RGBA
+#define GL_TEXTURE_SWIZZLE_RGBA 0x8E46
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+
+typedef void (GLAD_API_PTR *PFNGLGETQUERYOBJECTUI64VPROC)(GLuint id, GLenum pname, GLuint64* params);
+typedef void (GLAD_API_PTR *PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei buf_size, GLsizei* length, GLenum* binary_format, void* binary);
+typedef void (GLAD_API_PTR *PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binary_format, const void* binary, GLsizei length);
+typedef void (GLAD_API_PTR *PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (GLAD_API_PTR *PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+typedef void (GLAD_API_PTR *PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+extern PFNGLGETQUERYOBJECTUI64VPROC glad_glGetQueryObjectui64v;
+extern PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC glad_glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri;
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR;
+extern PFNGLBUFFERSTORAGEPROC glad_glBufferStorage;
+#define glGetQueryObjectui64v glad_glGetQueryObjectui64v
+#define glGetProgramBinary glad_glGetProgramBinary
+#define glProgramBinary glad_glProgramBinary
+#define glProgramParameteri glad_glProgramParameteri
+#define glMaxShaderCompilerThreadsKHR glad_glMaxShaderCompilerThreadsKHR
+#define glBufferStorage glad_glBufferStorage
+
+struct GLExtensions {
+    int MajorVersion {0};
+    int MinorVersion {0};
+    bool TimerQuery {false};
+    bool PipelineStatisticsQuery {false};
+    bool ProgramBinary {false};
+    bool ParallelShaderCompile {false};
+    bool TextureSwizzle {false};
+    bool TextureCompressionS3TC {false};
+    // Buffers mapped once and kept mapped while the GPU reads them
+    bool BufferStorage {false};
+};
+
+void GLExtensionsLoad(GLADloadfunc load);
+bool GLExtensionsHas(const char* name);
+const GLExtensions& GLExtensionsGet();
+// Applies to the current context only, a negative count lets the driver use as many threads as it wants
+void GLExtensionsSetCompilerThreads(int32_t threads);
@@ -0,0 +1,233 @@
+#include "glresource.h"
+#include "textureencoder.h"
+
+#include <mutex>
+#include <stdio.h>
+#include <unordered_map>
+
+static const char* ResourceTypeNames[EGLResourceTypeCount] = {
+    "programs",
+    "shaders",
+    "textures",
+    "framebuffers",
+    "buffers",
+    "vertex arrays",
+    "queries",
+};
+
+struct GLResourceTracker {
+    std::mutex Mutex;
+    std::unordered_map<GLuint, GLResourceInfo> Objects[EGLResourceTypeCount];
+    GLResourceStats Stats;
+    int64_t Budget {0};
+    bool IsOverBudget {false};
+};
+
+static GLResourceTracker& Tracker() {
+    static GLResourceTracker tracker;
+    return tracker;
+}
+
+GLuint GLResourceCreate(EGLResourceType type, GLenum shader_type) {
+    GLuint handle = 0;
+
+    switch (type) {
+        case EGLResourceTypeProgram: handle = glCreateProgram(); break;
+        case EGLResourceTypeShader: handle = glCreateShader(shader_type); break;
+        case EGLResourceTypeTexture: glGenTextures(1, &handle); break;
+        case EGLResourceTypeFramebuffer: glGenFramebuffers(1, &handle); break;
+        case EGLResourceTypeBuffer: glGenBuffers(1, &handle); break;
+        case EGLResourceTypeVertexArray: glGenVertexArrays(1, &handle); break;
+        case EGLResourceTypeQuery: glGenQueries(1, &handle); break;
+        case EGLResourceTypeCount: break;
+    }
+
+    if (handle != 0) {
+        GLResourceTracker& tracker = Tracker();
+        std::lock_guard<std::mutex> guard(tracker.Mutex);
+        tracker.Objects[type][handle] = GLResourceInfo();
+        ++tracker.Stats.Count[type];
+    }
+
+    return handle;
+}
+
+void GLResourceDestroy(EGLResourceType type, GLuint& handle) {
+    if (handle == 0) {
+        return;
+    }
+
+    switch (type) {
+        case EGLResourceTypeProgram: glDeleteProgram(handle); break;
+        case EGLResourceTypeShader: glDeleteShader(handle); break;
+        case EGLResourceTypeTexture: glDeleteTextures(1, &handle); break;
+        case EGLResourceTypeFramebuffer: glDeleteFramebuffers(1, &handle); break;
+        case EGLResourceTypeBuffer: glDeleteBuffers(1, &handle); break;
+        case EGLResourceTypeVertexArray: glDeleteVertexArrays(1, &handle); break;
+        case EGLResourceTypeQuery: glDeleteQueries(1, &handle); break;
+        case EGLResourceTypeCount: break;
+    }
+
+    {
+        GLResourceTracker& tracker = Tracker();
+        std::lock_guard<std::mutex> guard(tracker.Mutex);
+        auto it = tracker.Objects[type].find(handle);
+        if (it != tracker.Objects[type].end()) {
+            tracker.Stats.Bytes[type] -= it->second.Bytes;
+            --tracker.Stats.Count[type];
+            tracker.Objects[type].erase(it);
+        }
+    }
+
+    handle = 0;
+}
+
+void GLResourceDescribe(EGLResourceType type, GLuint handle, const GLResourceInfo& info) {
+    GLResourceTracker& tracker = Tracker();
+    std::lock_guard<std::mutex> guard(tracker.Mutex);
+    auto it = tracker.Objects[type].find(handle);
+    if (it == tracker.Objects[type].end()) {
+        return;
+    }
+
+    tracker.Stats.Bytes[type] += info.Bytes - it->second.Bytes;
+    it->second = info;
+
+    int64_t total = GLResourceTotalBytes(tracker.Stats);
+    bool is_over_budget = tracker.Budget > 0 && total > tracker.Budget;
+    if (is_over_budget && !tracker.IsOverBudget) {
+        fprintf(stderr, "GPU memory budget exceeded: %.2f MB used, %.2f MB budget\n",
+            total / (1024.0 * 1024.0), tracker.Budget / (1024.0 * 1024.0));
+    }
+    tracker.IsOverBudget = is_over_budget;
+}
+
+int64_t GLResourceTextureBytes(int width, int height, GLenum internal_format) {
+    if (TextureEncoderIsCompressed(internal_format)) {
+        return (int64_t)TextureEncoderBytes(internal_format, width, height);
+    }
+
+    int64_t bytes_per_pixel = 4;
+    switch (internal_format) {
+        case GL_R8: bytes_per_pixel = 1; break;
+        case GL_RG8: bytes_per_pixel = 2; break;
+        case GL_RGB8: bytes_per_pixel = 3; break;
+        case GL_R16: bytes_per_pixel = 2; break;
+        case GL_RG16: bytes_per_pixel = 4; break;
+        case GL_RGB16: bytes_per_pixel = 6; break;
+        case GL_RGBA16: bytes_per_pixel = 8; break;
+        case GL_RGBA16F: bytes_per_pixel = 8; break;
+        case GL_RG32F: bytes_per_pixel = 8; break;
+        case GL_RGBA32F: bytes_per_pixel = 16; break;
+        default: break;
+    }
+    return (int64_t)width * (int64_t)height * bytes_per_pixel;
+}
+
+const char* GLResourceFormatName(GLenum internal_format) {
+    switch (internal_format) {
+        case GL_R8: return "R8";
+        case GL_RG8: return "RG8";
+        case GL_RGB8: return "RGB8";
+        case GL_RGBA8: return "RGBA8";
+        case GL_R16: return "R16";
+        case GL_RG16: return "RG16";
+        case GL_RGB16: return "RGB16";
+        case GL_RGBA16: return "RGBA16";
+        case GL_RGBA16F: return "RGBA16F";
+        case GL_RG32F: return "RG32F";
+        case GL_RGBA32F: return "RGBA32F";
+        case GL_COMPRESSED_RED_RGTC1: return "BC4";
+        case GL_COMPRESSED_RG_RGTC2: return "BC5";
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return "BC1";
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+        default: return "";
+    }
+}
+
+GLResourceInfo GLResourceTextureInfo(const std::string& pass, const std::string& name, int width, int height, GLenum internal_format) {
+    GLResourceInfo info;
+    info.Pass = pass;
+    info.Name = name;
+    info.Width = width;
+    info.Height = height;
+    info.Format = internal_format;
+    info.Bytes = GLResourceTextureBytes(width, height, internal_format);
+    return info;
+}
+
+GLResourceInfo GLResourceBufferInfo(const std::string& pass, const std::string& name, int64_t bytes) {
+    GLResourceInfo info;
+    info.Pass = pass;
+    info.Name = name;
+    info.Bytes = bytes;
+    return info;
+}
+
+void GLResourceSetBudget(int64_t budget_bytes) {
+    GLResourceTracker& tracker = Tracker();
+    std::lock_guard<std::mutex> guard(tracker.Mutex);
+    tracker.Budget = budget_bytes;
+    tracker.IsOverBudget = false;
+}
+
+int64_t GLResourceGetBudget() {
+    GLResourceTracker& tracker = Tracker();
+    std::lock_guard<std::mutex> guard(tracker.Mutex);
+    return tracker.Budget;
+}
+
+int64_t GLResourceTotalBytes(const GLResourceStats& stats) {
+    int64_t total = 0;
+    for (int i = 0; i < EGLResourceTypeCount; ++i) {
+        total += stats.Bytes[i];
+    }
+    return total;
+}
+
+std::vector<GLResourceEntry> GLResourceList() {
+    GLResourceTracker& tracker = Tracker();
+    std::lock_guard<std::mutex> guard(tracker.Mutex);
+
+    std::vector<GLResourceEntry> entries;
+    for (int i = 0; i < EGLResourceTypeCount; ++i) {
+        for (const auto& object : tracker.Objects[i]) {
+            if (object.second.Bytes > 0) {
+                entries.push_back({(EGLResourceType)i, object.first, object.second});
+            }
+        }
+    }
+    return entries;
+}
+
+GLResourceStats GLResourceGetStats() {
+    GLResourceTracker& tracker = Tracker();
+    std::lock_guard<std::mutex> guard(tracker.Mutex);
+    return tracker.Stats;
+}
+
+GLResourceStats GLResourceStatsSubtract(const GLResourceStats& a, const GLResourceStats& b) {
+    GLResourceStats stats;
+    for (int i = 0; i < EGLResourceTypeCount; ++i) {
+        stats.Count[i] = a.Count[i] - b.Count[i];
+        stats.Bytes[i] = a.Bytes[i] - b.Bytes[i];
+    }
+    return stats;
+}
+
+bool GLResourceReportGrowth(const GLResourceStats& baseline, const GLResourceStats& current, std::string& report) {
+    bool has_grown = false;
+
+    for (int i = 0; i < EGLResourceTypeCount; ++i) {
+        if (current.Count[i] <= baseline.Count[i] && current.Bytes[i] <= baseline.Bytes[i]) {
+            continue;
+        }
+
+        has_grown = true;
+        report += std::string(ResourceTypeNames[i]) + ": " +
+            std::to_string(baseline.Count[i]) + " -> " + std::to_string(current.Count[i]) + " (" +
+            std::to_string(baseline.Bytes[i]) + " -> " + std::to_string(current.Bytes[i]) + " bytes)\n";
+    }
+
+    return has_grown;
+}
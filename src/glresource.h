@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum EGLResourceType {
+    EGLResourceTypeProgram,
+    EGLResourceTypeShader,
+    EGLResourceTypeTexture,
+    EGLResourceTypeFramebuffer,
+    EGLResourceTypeBuffer,
+    EGLResourceTypeVertexArray,
+    EGLResourceTypeQuery,
+    EGLResourceTypeCount,
+};
+
+struct GLResourceStats {
+    int64_t Count[EGLResourceTypeCount] {};
+    int64_t Bytes[EGLResourceTypeCount] {};
+};
+
+struct GLResourceInfo {
+    std::string Pass;
+    std::string Name;
+    int Width {0};
+    int Height {0};
+    GLenum Format {0};
+    int64_t Bytes {0};
+};
+
+struct GLResourceEntry {
+    EGLResourceType Type;
+    GLuint Handle;
+    GLResourceInfo Info;
+};
+
+// Every GL object of the tool is created and destroyed through these functions,
+// which keep live object counters and byte estimates for each category.
+GLuint GLResourceCreate(EGLResourceType type, GLenum shader_type = 0);
+void GLResourceDestroy(EGLResourceType type, GLuint& handle);
+void GLResourceDescribe(EGLResourceType type, GLuint handle, const GLResourceInfo& info);
+int64_t GLResourceTextureBytes(int width, int height, GLenum internal_format);
+const char* GLResourceFormatName(GLenum internal_format);
+GLResourceInfo GLResourceTextureInfo(const std::string& pass, const std::string& name, int width, int height, GLenum internal_format);
+GLResourceInfo GLResourceBufferInfo(const std::string& pass, const std::string& name, int64_t bytes);
+
+// A budget of 0 disables the memory budget, it is reported once each time the total crosses it
+void GLResourceSetBudget(int64_t budget_bytes);
+int64_t GLResourceGetBudget();
+int64_t GLResourceTotalBytes(const GLResourceStats& stats);
+std::vector<GLResourceEntry> GLResourceList();
+
+GLResourceStats GLResourceGetStats();
+GLResourceStats GLResourceStatsSubtract(const GLResourceStats& a, const GLResourceStats& b);
+bool GLResourceReportGrowth(const GLResourceStats& baseline, const GLResourceStats& current, std::string& report);
@@ -6,9 +6,13 @@
 #include <GLFW/glfw3.h>
 
 #include "shader.h"
+#include "glresource.h"
 
 #include <fstream>
 #include <sstream>
+#include <map>
+#include <algorithm>
+#include <cmath>
 
 extern "C" {
 #include <microui/microui.h>
@@ -38,6 +42,7 @@ struct GUI {
     int Height;
     int CursorX;
     int CursorY;
+    bool ShowTools;
     std::string Log;
 };
 
@@ -220,6 +225,7 @@ HGUI GUIInit(GLFWwindow* window_handle, int width, int height) {
     gui->Window = window_handle;
     gui->Width = width;
     gui->Height = height;
+    gui->ShowTools = false;
 
     memset(gui->Atlas, 0x0, sizeof(gui->Atlas));
     gui->Atlas[ MU_ICON_CLOSE ] = { 88, 68, 16, 16 };
@@ -348,9 +354,10 @@ HGUI GUIInit(GLFWwindow* window_handle, int width, int height) {
         }
     }
 
-    glGenTextures(1, &gui->AtlasId);
+    gui->AtlasId = GLResourceCreate(EGLResourceTypeTexture);
     glBindTexture(GL_TEXTURE_2D, gui->AtlasId);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba8_pixels);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba8_pixels);
+    GLResourceDescribe(EGLResourceTypeTexture, gui->AtlasId, GLResourceTextureInfo("gui", "font atlas", ATLAS_WIDTH, ATLAS_HEIGHT, GL_RGBA8));
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -388,21 +395,25 @@ HGUI GUIInit(GLFWwindow* window_handle, int width, int height) {
         printf("%s\n", error.c_str());
     }
 
-    glGenBuffers(1, &gui->ColorBuffer);
+    gui->ColorBuffer = GLResourceCreate(EGLResourceTypeBuffer);
     glBindBuffer(GL_ARRAY_BUFFER, gui->ColorBuffer);
     glBufferData(GL_ARRAY_BUFFER, sizeof(gui->ColorArray), nullptr, GL_STREAM_DRAW);
+    GLResourceDescribe(EGLResourceTypeBuffer, gui->ColorBuffer, GLResourceBufferInfo("gui", "color buffer", sizeof(gui->ColorArray)));
 
-    glGenBuffers(1, &gui->UVBuffer);
+    gui->UVBuffer = GLResourceCreate(EGLResourceTypeBuffer);
     glBindBuffer(GL_ARRAY_BUFFER, gui->UVBuffer);
     glBufferData(GL_ARRAY_BUFFER, sizeof(gui->UVArray), nullptr, GL_STREAM_DRAW);
+    GLResourceDescribe(EGLResourceTypeBuffer, gui->UVBuffer, GLResourceBufferInfo("gui", "uv buffer", sizeof(gui->UVArray)));
 
-    glGenBuffers(1, &gui->VertexBuffer);
+    gui->VertexBuffer = GLResourceCreate(EGLResourceTypeBuffer);
     glBindBuffer(GL_ARRAY_BUFFER, gui->VertexBuffer);
     glBufferData(GL_ARRAY_BUFFER, sizeof(gui->VertexArray), nullptr, GL_STREAM_DRAW);
+    GLResourceDescribe(EGLResourceTypeBuffer, gui->VertexBuffer, GLResourceBufferInfo("gui", "vertex buffer", sizeof(gui->VertexArray)));
 
-    glGenBuffers(1, &gui->IndexBuff);
+    gui->IndexBuff = GLResourceCreate(EGLResourceTypeBuffer);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gui->IndexBuff);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(gui->IndexArray), nullptr, GL_STREAM_DRAW);
+    GLResourceDescribe(EGLResourceTypeBuffer, gui->IndexBuff, GLResourceBufferInfo("gui", "index buffer", sizeof(gui->IndexArray)));
 
     gui->Ctx = new mu_Context();
     mu_init(gui->Ctx);
@@ -446,22 +457,243 @@ void GUIClearLog(HGUI handle) {
     gui->Log = "";
 }
 
-bool GUINewFrame(HGUI handle, std::vector<GUIComponent>& gui_components, std::vector<GUITexture> textures) {
-    if (gui_components.empty() && textures.empty()) {
-        return false;
+void GUIToggleTools(HGUI handle) {
+    GUI* gui = (GUI*)handle;
+    gui->ShowTools = !gui->ShowTools;
+}
+
+static void ClockPanel(GUI* gui, FrameClock& clock) {
+    if (!mu_header_ex(gui->Ctx, "Clock", MU_OPT_EXPANDED)) {
+        return;
+    }
+
+    char label[64];
+    int button_widths[3] = {70, 70, -1};
+    mu_layout_row(gui->Ctx, 3, button_widths, 0);
+    if (mu_button(gui->Ctx, clock.IsPaused ? "Resume" : "Pause")) {
+        FrameClockSetPaused(clock, !clock.IsPaused);
+    }
+    if (mu_button(gui->Ctx, "Step")) {
+        FrameClockStep(clock);
+    }
+    snprintf(label, sizeof(label), "frame %llu", (unsigned long long)clock.FrameIndex);
+    mu_label(gui->Ctx, label);
+
+    int column_widths[2] = {150, -1};
+    mu_layout_row(gui->Ctx, 2, column_widths, 0);
+
+    // Scrub over the minute the clock is in and the ones before, so that the thumb
+    // moves along while the range grows a minute at a time
+    mu_Real time = clock.Time;
+    mu_Real scrub_range = (mu_Real)(60.0 * (std::floor(std::max(clock.Time, 0.0) / 60.0) + 1.0));
+    if (mu_slider_ex(gui->Ctx, &time, 0.0f, scrub_range, 0.0f, "%.2f", MU_OPT_ALIGNCENTER) & MU_RES_CHANGE) {
+        FrameClockSeek(clock, time);
+    }
+    mu_label(gui->Ctx, "time");
+
+    mu_Real fixed_timestep = clock.FixedTimestep;
+    if (mu_number_ex(gui->Ctx, &fixed_timestep, 0.001f, "%.4f", MU_OPT_ALIGNCENTER) & MU_RES_CHANGE) {
+        clock.FixedTimestep = fixed_timestep > 0.0f ? fixed_timestep : 0.0;
+    }
+    mu_label(gui->Ctx, "fixed timestep");
+}
+
+static void MemoryPanel(GUI* gui) {
+    if (!mu_header_ex(gui->Ctx, "GPU Memory", 0)) {
+        return;
+    }
+
+    const double megabyte = 1024.0 * 1024.0;
+
+    std::vector<GLResourceEntry> entries = GLResourceList();
+    std::sort(entries.begin(), entries.end(), [](const GLResourceEntry& a, const GLResourceEntry& b) {
+        return a.Info.Bytes > b.Info.Bytes;
+    });
+
+    int64_t total_bytes = 0;
+    std::map<std::string, int64_t> pass_bytes;
+    for (const GLResourceEntry& entry : entries) {
+        total_bytes += entry.Info.Bytes;
+        pass_bytes[entry.Info.Pass.empty() ? "shared" : entry.Info.Pass] += entry.Info.Bytes;
+    }
+
+    char label[256];
+    int empty_width[1] = {-1};
+    mu_layout_row(gui->Ctx, 1, empty_width, 0);
+
+    int64_t budget_bytes = GLResourceGetBudget();
+    if (budget_bytes > 0) {
+        snprintf(label, sizeof(label), "%s%.2f MB of %.2f MB budget", total_bytes > budget_bytes ? "OVER BUDGET " : "",
+            total_bytes / megabyte, budget_bytes / megabyte);
+    } else {
+        snprintf(label, sizeof(label), "%.2f MB total", total_bytes / megabyte);
+    }
+    mu_label(gui->Ctx, label);
+
+    int column_widths[2] = {150, -1};
+    mu_layout_row(gui->Ctx, 2, column_widths, 0);
+    for (const auto& pass : pass_bytes) {
+        mu_label(gui->Ctx, pass.first.c_str());
+        snprintf(label, sizeof(label), "%.2f MB", pass.second / megabyte);
+        mu_label(gui->Ctx, label);
+    }
+
+    mu_layout_row(gui->Ctx, 1, empty_width, 0);
+    for (const GLResourceEntry& entry : entries) {
+        if (entry.Type == EGLResourceTypeTexture) {
+            snprintf(label, sizeof(label), "%s %dx%d %s %.2f MB", entry.Info.Name.c_str(),
+                entry.Info.Width, entry.Info.Height, GLResourceFormatName(entry.Info.Format), entry.Info.Bytes / megabyte);
+        } else {
+            snprintf(label, sizeof(label), "%s %.2f MB", entry.Info.Name.c_str(), entry.Info.Bytes / megabyte);
+        }
+        mu_label(gui->Ctx, label);
+    }
+}
+
+static void TimingPanel(GUI* gui, GUITools& tools) {
+    if (!mu_header_ex(gui->Ctx, "GPU Timings", MU_OPT_EXPANDED)) {
+        return;
+    }
+
+    int empty_width[1] = {-1};
+    if (!ProfilerIsSupported(tools.Profiler)) {
+        mu_layout_row(gui->Ctx, 1, empty_width, 0);
+        mu_label(gui->Ctx, "Timer queries are not supported");
+        return;
+    }
+
+    // Frame time graph, scaled to at least a 60Hz frame
+    std::vector<float> frame_times = ProfilerGetFrameTimes(tools.Profiler);
+    float max_frame_time = 1000.0f / 60.0f;
+    for (float frame_time : frame_times) {
+        max_frame_time = std::max(max_frame_time, frame_time);
+    }
+
+    mu_layout_row(gui->Ctx, 1, empty_width, 50);
+    mu_Rect graph = mu_layout_next(gui->Ctx);
+    mu_draw_rect(gui->Ctx, graph, gui->Ctx->style->colors[MU_COLOR_BASE]);
+    if (!frame_times.empty()) {
+        float bar_width = (float)graph.w / frame_times.size();
+        for (size_t i = 0; i < frame_times.size(); ++i) {
+            int bar_height = (int)(graph.h * frame_times[i] / max_frame_time);
+            mu_Rect bar = mu_rect(graph.x + (int)(i * bar_width), graph.y + graph.h - bar_height, std::max(1, (int)bar_width), bar_height);
+            mu_draw_rect(gui->Ctx, bar, frame_times[i] > 1000.0f / 60.0f ? mu_color(255, 90, 60, 255) : mu_color(90, 200, 120, 255));
+        }
+    }
+
+    char label[64];
+    int column_widths[4] = {105, 60, 60, -1};
+    mu_layout_row(gui->Ctx, 4, column_widths, 0);
+    mu_label(gui->Ctx, "pass");
+    mu_label(gui->Ctx, "avg ms");
+    mu_label(gui->Ctx, "min ms");
+    mu_label(gui->Ctx, "max ms");
+    for (const ProfilerPassTiming& timing : ProfilerGetPassTimings(tools.Profiler)) {
+        mu_label(gui->Ctx, timing.Name.c_str());
+        snprintf(label, sizeof(label), "%.3f", timing.AverageMS);
+        mu_label(gui->Ctx, label);
+        snprintf(label, sizeof(label), "%.3f", timing.MinMS);
+        mu_label(gui->Ctx, label);
+        snprintf(label, sizeof(label), "%.3f", timing.MaxMS);
+        mu_label(gui->Ctx, label);
+    }
+
+    int statistics = ProfilerGetStatistics(tools.Profiler);
+    mu_layout_row(gui->Ctx, 1, empty_width, 0);
+    if (mu_checkbox(gui->Ctx, "Pipeline statistics", &statistics)) {
+        ProfilerSetStatistics(tools.Profiler, statistics != 0);
+    }
+
+    if (statistics) {
+        // Fragments per pixel above one points at overdraw, time per fragment at shader cost
+        bool has_invocations = ProfilerHasFragmentInvocations(tools.Profiler);
+        mu_layout_row(gui->Ctx, 4, column_widths, 0);
+        mu_label(gui->Ctx, "pass");
+        mu_label(gui->Ctx, "frags/px");
+        mu_label(gui->Ctx, "samples/px");
+        mu_label(gui->Ctx, "ns/frag");
+        for (const ProfilerPassTiming& timing : ProfilerGetPassTimings(tools.Profiler)) {
+            if (!timing.HasStatistics || timing.Pixels == 0) {
+                continue;
+            }
+            mu_label(gui->Ctx, timing.Name.c_str());
+            if (has_invocations) {
+                snprintf(label, sizeof(label), "%.2f", (double)timing.FragmentInvocations / timing.Pixels);
+            } else {
+                snprintf(label, sizeof(label), "n/a");
+            }
+            mu_label(gui->Ctx, label);
+            snprintf(label, sizeof(label), "%.2f", (double)timing.SamplesPassed / timing.Pixels);
+            mu_label(gui->Ctx, label);
+            uint64_t fragments = has_invocations ? timing.FragmentInvocations : timing.Pixels;
+            snprintf(label, sizeof(label), "%.3f", fragments > 0 ? timing.AverageMS * 1000000.0 / fragments : 0.0);
+            mu_label(gui->Ctx, label);
+        }
+    }
+
+    int button_widths[2] = {120, -1};
+    mu_layout_row(gui->Ctx, 2, button_widths, 0);
+    if (mu_button(gui->Ctx, "Export CSV")) {
+        ProfilerExport(tools.Profiler, tools.ExportPath + ".csv");
+    }
+    if (mu_button(gui->Ctx, "Export JSON")) {
+        ProfilerExport(tools.Profiler, tools.ExportPath + ".json");
+    }
+}
+
+static void HeatmapPanel(GUI* gui, GUITools& tools) {
+    if (!mu_header_ex(gui->Ctx, "Heatmap", 0)) {
+        return;
+    }
+
+    HeatmapSettings& settings = *tools.Heatmap;
+    if (settings.PassIndex >= tools.PassNames.size()) {
+        settings.PassIndex = 0;
     }
 
+    int enabled = settings.Enabled;
+    int show_fetches = settings.ShowFetches;
+    int button_widths[2] = {120, -1};
+    mu_layout_row(gui->Ctx, 2, button_widths, 0);
+    if (mu_checkbox(gui->Ctx, "Enabled", &enabled)) {
+        settings.Enabled = enabled != 0;
+    }
+    if (mu_checkbox(gui->Ctx, "Texture fetches", &show_fetches)) {
+        settings.ShowFetches = show_fetches != 0;
+    }
+
+    if (!tools.PassNames.empty()) {
+        if (mu_button(gui->Ctx, "Next pass")) {
+            settings.PassIndex = (settings.PassIndex + 1) % tools.PassNames.size();
+        }
+        mu_label(gui->Ctx, tools.PassNames[settings.PassIndex].c_str());
+    }
+
+    int column_widths[2] = {150, -1};
+    mu_layout_row(gui->Ctx, 2, column_widths, 0);
+    mu_slider_ex(gui->Ctx, &settings.MaxCount, 1.0f, 1024.0f, 1.0f, "%.0f", MU_OPT_ALIGNCENTER);
+    mu_label(gui->Ctx, settings.ShowFetches ? "max fetches" : "max iterations");
+
+    if (!tools.HeatmapError.empty()) {
+        int empty_width[1] = {-1};
+        mu_layout_row(gui->Ctx, 1, empty_width, 0);
+        mu_text(gui->Ctx, tools.HeatmapError.c_str());
+    }
+}
+
+bool GUINewFrame(HGUI handle, std::vector<GUIComponent>& gui_components, std::vector<GUITexture> textures, GUITools& tools) {
+    GUI* gui = (GUI*)handle;
+
     uint32_t components_in_use = 0;
     for (const GUIComponent& component : gui_components) {
         if (component.IsInUse)
             ++components_in_use;
     }
 
-    if (components_in_use == 0 && textures.empty()) {
+    if (components_in_use == 0 && textures.empty() && !gui->ShowTools) {
         return false;
     }
 
-    GUI* gui = (GUI*)handle;
     int window_w = 300;
     int empty_width[1] = {-1};
 
@@ -487,11 +719,40 @@ bool GUINewFrame(HGUI handle, std::vector<GUIComponent>& gui_components, std::ve
             int component_4_w = (component_1_w / 4.0f) - gui->Ctx->style->padding * 0.5f;
             int component_5_w = (component_1_w / 5.0f) - gui->Ctx->style->padding * 0.5f;
 
+            if (components_in_use > 0 && tools.Freeze) {
+                int freeze = *tools.Freeze;
+                mu_layout_row(gui->Ctx, 1, empty_width, 0);
+                if (mu_checkbox(gui->Ctx, "Freeze uniforms", &freeze)) {
+                    *tools.Freeze = freeze != 0;
+                }
+            }
+
             for (GUIComponent& component : gui_components) {
                 if (!component.IsInUse) {
                     continue;
                 }
 
+                if (GUIIsDefineType(component.Type)) {
+                    int column_widths[2] = {column_1_w, column_2_w};
+                    mu_layout_row(gui->Ctx, 2, column_widths, 0);
+                    mu_push_id(gui->Ctx, component.UniformName.c_str(), (int)component.UniformName.size());
+                    if (component.Type == EGUIComponentTypeToggle) {
+                        int enabled = component.Data[0] != 0.0f;
+                        if (mu_checkbox(gui->Ctx, enabled ? "on" : "off", &enabled)) {
+                            component.Data[0] = enabled ? 1.0f : 0.0f;
+                        }
+                    } else if (!component.Choices.empty()) {
+                        // Each click selects the next value
+                        uint32_t index = (uint32_t)component.Data[0] % component.Choices.size();
+                        if (mu_button(gui->Ctx, component.Choices[index].c_str())) {
+                            component.Data[0] = (float)((index + 1) % component.Choices.size());
+                        }
+                    }
+                    mu_pop_id(gui->Ctx);
+                    mu_label(gui->Ctx, component.UniformName.c_str());
+                    continue;
+                }
+
                 int column_widths[2] = {column_1_w, column_2_w};
                 mu_layout_row(gui->Ctx, 2, column_widths, 0);
                 mu_layout_begin_column(gui->Ctx);
@@ -521,6 +782,10 @@ bool GUINewFrame(HGUI handle, std::vector<GUIComponent>& gui_components, std::ve
                         mu_layout_row(gui->Ctx, 5, widths, 0);
                         break;
                     }
+                    case EGUIComponentTypeToggle:
+                    case EGUIComponentTypeChoice:
+                        // Laid out on a single row above
+                        break;
                 }
 
                 if (GUIIsSliderType(component.Type)) {
@@ -548,6 +813,13 @@ bool GUINewFrame(HGUI handle, std::vector<GUIComponent>& gui_components, std::ve
                 mu_label(gui->Ctx, component.UniformName.c_str());
                 mu_layout_end_column(gui->Ctx);
             }
+
+            if (gui->ShowTools) {
+                ClockPanel(gui, *tools.Clock);
+                TimingPanel(gui, tools);
+                HeatmapPanel(gui, tools);
+                MemoryPanel(gui);
+            }
         }
 #if 0
         for (const auto& texture : textures) {
@@ -592,6 +864,11 @@ void GUIDestroy(HGUI handle) {
     GUI* gui = (GUI*)handle;
     delete gui->Ctx;
     ShaderProgramDestroy(gui->Program);
+    GLResourceDestroy(EGLResourceTypeTexture, gui->AtlasId);
+    GLResourceDestroy(EGLResourceTypeBuffer, gui->ColorBuffer);
+    GLResourceDestroy(EGLResourceTypeBuffer, gui->UVBuffer);
+    GLResourceDestroy(EGLResourceTypeBuffer, gui->VertexBuffer);
+    GLResourceDestroy(EGLResourceTypeBuffer, gui->IndexBuff);
     delete gui;
 }
 
@@ -656,6 +933,12 @@ bool GUIComponentLoad(const std::string& path, std::vector<GUIComponent>& out_co
             comp.Data[1] = y;
             comp.Data[2] = z;
             comp.Data[3] = w;
+        } else if (type == "t" || type == "ch") {
+            float value;
+            iss >> value;
+            comp.Type = type == "t" ? EGUIComponentTypeToggle : EGUIComponentTypeChoice;
+            comp.UniformName = uniformName;
+            comp.Data[0] = value;
         }
         out_components.push_back(comp);
     }
@@ -715,6 +998,16 @@ bool GUIComponentSave(const std::string& path, const std::vector<GUIComponent>&
                 file << component.Data[3];
                 file << std::endl;
                 break;
+            case EGUIComponentTypeToggle:
+                file << component.UniformName << " t ";
+                file << component.Data[0];
+                file << std::endl;
+                break;
+            case EGUIComponentTypeChoice:
+                file << component.UniformName << " ch ";
+                file << component.Data[0];
+                file << std::endl;
+                break;
         }
     }
     
@@ -722,6 +1015,74 @@ bool GUIComponentSave(const std::string& path, const std::vector<GUIComponent>&
     return true;
 }
 
+template <typename FReportError>
+static bool GUIComponentParseDefine(const std::string& component_name, const std::string& component_data, const std::string& define_line, const std::vector<GUIComponent>& previous_components, GUIComponent& out_component, FReportError ReportError) {
+    size_t define_start = define_line.find_first_not_of(" \t");
+    std::vector<std::string> define_tokens = SplitString(define_start == std::string::npos ? "" : define_line.substr(define_start), ' ');
+    if (define_tokens.size() < 2 || define_tokens[0] != "#define") {
+        ReportError("@" + component_name + " is not associated with a #define");
+        return false;
+    }
+
+    out_component.UniformType = EGUIUniformTypeFloat;
+    out_component.UniformName = define_tokens[1];
+    out_component.Choices.clear();
+
+    if (out_component.Type == EGUIComponentTypeToggle) {
+        if (!component_data.empty()) {
+            ReportError("Format should be @toggle");
+            return false;
+        }
+
+        // The define is present in the source, the toggle starts enabled
+        out_component.Define.Default = 1;
+    } else {
+        if (component_data.size() < 2 || component_data.front() != '(' || component_data.back() != ')') {
+            ReportError("Format should be @choice(value_0, value_1, ...)");
+            return false;
+        }
+
+        for (std::string choice : SplitString(component_data.substr(1, component_data.size() - 2), ',')) {
+            size_t first = choice.find_first_not_of(" \t");
+            size_t last = choice.find_last_not_of(" \t");
+            if (first != std::string::npos) {
+                out_component.Choices.push_back(choice.substr(first, last - first + 1));
+            }
+        }
+
+        std::string value;
+        for (size_t i = 2; i < define_tokens.size(); ++i) {
+            value += (i > 2 ? " " : "") + define_tokens[i];
+        }
+
+        if (value.empty()) {
+            ReportError("@choice is associated with a #define without value");
+            return false;
+        }
+
+        // The value from the source is always one of the choices
+        auto it = std::find(out_component.Choices.begin(), out_component.Choices.end(), value);
+        out_component.Define.Default = (uint32_t)(it - out_component.Choices.begin());
+        if (it == out_component.Choices.end()) {
+            out_component.Choices.push_back(value);
+        }
+    }
+
+    out_component.Data[0] = (float)out_component.Define.Default;
+
+    for (const GUIComponent& previous_component : previous_components) {
+        if (previous_component.UniformName == out_component.UniformName) {
+            memcpy(&out_component.Data, &previous_component.Data, sizeof(out_component.Data));
+        }
+    }
+
+    if (out_component.Data[0] < 0.0f || (uint32_t)out_component.Data[0] >= GUIDefineValues(out_component)) {
+        out_component.Data[0] = (float)out_component.Define.Default;
+    }
+
+    return true;
+}
+
 bool GUIComponentParse(uint32_t line_number, const std::string& gui_component_line, const std::string& uniform_line, const std::vector<GUIComponent>& previous_components, GUIComponent& out_component, std::string& out_parse_error) {
     auto ReportError = [&](const std::string& error) {
         out_parse_error = error + " at line " + std::to_string(line_number);
@@ -749,11 +1110,19 @@ bool GUIComponentParse(uint32_t line_number, const std::string& gui_component_li
         out_component.Type = EGUIComponentTypeColor3;
     } else if (component_name == "color4") {
         out_component.Type = EGUIComponentTypeColor4;
+    } else if (component_name == "toggle") {
+        out_component.Type = EGUIComponentTypeToggle;
+    } else if (component_name == "choice") {
+        out_component.Type = EGUIComponentTypeChoice;
     } else {
         ReportError("Invalid GUI type name '" + component_name + "'");
         return false;
     }
 
+    if (GUIIsDefineType(out_component.Type)) {
+        return GUIComponentParseDefine(component_name, component_data, uniform_line, previous_components, out_component, ReportError);
+    }
+
     if (!component_data.empty()) {
         if (GUIIsSliderType(out_component.Type)) {
             int scanned = sscanf(component_data.c_str(), "(%f, %f)",
@@ -8,6 +8,10 @@
 
 #include <glad/gl.h>
 
+#include "frameclock.h"
+#include "profiler.h"
+#include "heatmap.h"
+
 struct GLFWwindow;
 
 enum EGUIComponentType {
@@ -17,6 +21,8 @@ enum EGUIComponentType {
     EGUIComponentTypeSlider4,
     EGUIComponentTypeColor3,
     EGUIComponentTypeColor4,
+    EGUIComponentTypeToggle,
+    EGUIComponentTypeChoice,
 };
 
 enum EGUIUniformType {
@@ -31,6 +37,10 @@ struct GUIComponentSliderRange {
     float End;
 };
 
+struct GUIComponentDefine {
+    uint32_t Default;
+};
+
 struct vec2 {
     float x,y;
 };
@@ -53,6 +63,8 @@ struct GUIComponent {
         UniformName = other.UniformName;
         IsInUse = other.IsInUse;
         SliderRange = other.SliderRange;
+        Define = other.Define;
+        Choices = other.Choices;
         memcpy(Data, other.Data, sizeof(Data));
     }
     EGUIComponentType Type;
@@ -61,10 +73,17 @@ struct GUIComponent {
     bool IsInUse;
     union {
         GUIComponentSliderRange SliderRange;
+        GUIComponentDefine Define;
     };
+    // Values of a choice, a define component stores the selected index or the toggle state in Data[0]
+    std::vector<std::string> Choices;
     float Data[4];
 };
 
+inline uint32_t GUIDefineValues(const GUIComponent& component) {
+    return component.Type == EGUIComponentTypeToggle ? 2 : (uint32_t)component.Choices.size();
+}
+
 inline bool GUIIsSliderType(EGUIComponentType type) {
     return type == EGUIComponentTypeSlider1 ||
            type == EGUIComponentTypeSlider2 ||
@@ -72,8 +91,15 @@ inline bool GUIIsSliderType(EGUIComponentType type) {
            type == EGUIComponentTypeSlider4;
 }
 
+inline bool GUIIsDefineType(EGUIComponentType type) {
+    return type == EGUIComponentTypeToggle ||
+           type == EGUIComponentTypeChoice;
+}
+
 inline uint32_t GUIComponents(EGUIComponentType type) {
     switch (type) {
+        case EGUIComponentTypeToggle:
+        case EGUIComponentTypeChoice:
         case EGUIComponentTypeSlider1:
         return 1;
         case EGUIComponentTypeSlider2:
@@ -106,12 +132,23 @@ struct GUITexture {
     int Height;
 };
 
+struct GUITools {
+    FrameClock* Clock {nullptr};
+    HProfiler Profiler {nullptr};
+    HeatmapSettings* Heatmap {nullptr};
+    bool* Freeze {nullptr};
+    std::vector<std::string> PassNames;
+    std::string HeatmapError;
+    std::string ExportPath;
+};
+
 typedef void* HGUI;
 
 HGUI GUIInit(GLFWwindow* window_handle, int width, int height);
 void GUIKeyCallback(HGUI gui, int key, int scancode, int action, int mods);
 void GUIMouseButtonCallback(HGUI gui, int button, int action, int mods);
-bool GUINewFrame(HGUI gui, std::vector<GUIComponent>& gui_components, std::vector<GUITexture> textures);
+bool GUINewFrame(HGUI gui, std::vector<GUIComponent>& gui_components, std::vector<GUITexture> textures, GUITools& tools);
+void GUIToggleTools(HGUI gui);
 void GUIRender(HGUI gui);
 void GUIResize(HGUI, int widht, int height);
 void GUIDestroy(HGUI gui);
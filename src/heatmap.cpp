@@ -0,0 +1,123 @@
+#include "heatmap.h"
+
+#include "shader.h"
+#include "glresource.h"
+
+#include <stdio.h>
+
+static const GLchar* OverlayVertexShader = R"END(
+in vec2 position;
+void main() {
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+)END";
+
+static const GLchar* OverlayFragmentShader = R"END(
+uniform sampler2D heat;
+uniform vec2 resolution;
+uniform float max_count;
+uniform int show_fetches;
+out vec4 color;
+void main() {
+    vec2 counts = texture(heat, gl_FragCoord.xy / resolution).rg;
+    float t = clamp((show_fetches != 0 ? counts.g : counts.r) / max_count, 0.0, 1.0);
+    // Blue for no work up to red at the maximum count
+    color = vec4(clamp(1.5 - abs(4.0 * t - vec3(3.0, 2.0, 1.0)), 0.0, 1.0), 1.0);
+}
+)END";
+
+struct Heatmap {
+    ShaderProgram OverlayProgram;
+    GLuint FBO;
+    GLuint TextureId;
+    uint32_t Width;
+    uint32_t Height;
+};
+
+HHeatmap HeatmapCreate() {
+    Heatmap* heatmap = new Heatmap();
+    heatmap->FBO = 0;
+    heatmap->TextureId = 0;
+    heatmap->Width = 0;
+    heatmap->Height = 0;
+
+    std::string error;
+    if (!ShaderProgramCreate(heatmap->OverlayProgram, OverlayFragmentShader, OverlayVertexShader, error)) {
+        fprintf(stderr, "Failed to create heatmap overlay program: %s\n", error.c_str());
+    }
+
+    return heatmap;
+}
+
+void HeatmapDestroy(HHeatmap handle) {
+    Heatmap* heatmap = (Heatmap*)handle;
+    ShaderProgramDestroy(heatmap->OverlayProgram);
+    GLResourceDestroy(EGLResourceTypeTexture, heatmap->TextureId);
+    GLResourceDestroy(EGLResourceTypeFramebuffer, heatmap->FBO);
+    delete heatmap;
+}
+
+void HeatmapBeginPass(HHeatmap handle, uint32_t width, uint32_t height) {
+    Heatmap* heatmap = (Heatmap*)handle;
+
+    if (heatmap->FBO == 0 || heatmap->Width != width || heatmap->Height != height) {
+        GLResourceDestroy(EGLResourceTypeTexture, heatmap->TextureId);
+        GLResourceDestroy(EGLResourceTypeFramebuffer, heatmap->FBO);
+
+        heatmap->Width = width;
+        heatmap->Height = height;
+
+        heatmap->FBO = GLResourceCreate(EGLResourceTypeFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, heatmap->FBO);
+
+        // Counts go above one, they need a float target
+        heatmap->TextureId = GLResourceCreate(EGLResourceTypeTexture);
+        glBindTexture(GL_TEXTURE_2D, heatmap->TextureId);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, width, height, 0, GL_RG, GL_FLOAT, NULL);
+        GLResourceDescribe(EGLResourceTypeTexture, heatmap->TextureId, GLResourceTextureInfo("", "heatmap", width, height, GL_RG32F));
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, heatmap->TextureId, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, heatmap->FBO);
+    glViewport(0, 0, width, height);
+
+    GLfloat clear_color[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+}
+
+void HeatmapDrawOverlay(HHeatmap handle, const HeatmapSettings& settings, GLuint vertex_buffer, uint32_t width, uint32_t height) {
+    Heatmap* heatmap = (Heatmap*)handle;
+    GLuint program = heatmap->OverlayProgram.Handle;
+
+    if (program == 0 || heatmap->TextureId == 0) {
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+    glUseProgram(program);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, heatmap->TextureId);
+    glUniform1i(glGetUniformLocation(program, "heat"), 0);
+    glUniform2f(glGetUniformLocation(program, "resolution"), width, height);
+    glUniform1f(glGetUniformLocation(program, "max_count"), settings.MaxCount > 0.0f ? settings.MaxCount : 1.0f);
+    glUniform1i(glGetUniformLocation(program, "show_fetches"), settings.ShowFetches ? 1 : 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    GLint position_attrib = glGetAttribLocation(program, "position");
+    glVertexAttribPointer(position_attrib, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), 0);
+    glEnableVertexAttribArray(position_attrib);
+
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+}
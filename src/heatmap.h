@@ -0,0 +1,21 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <stdint.h>
+
+struct HeatmapSettings {
+    bool Enabled {false};
+    bool ShowFetches {false};
+    float MaxCount {64.0f};
+    uint32_t PassIndex {0};
+};
+
+typedef void* HHeatmap;
+
+// The heatmap renders the instrumented variant of a pass into a float target
+// holding loop iterations and texture fetches per pixel, and draws it over the
+// window as a false color overlay.
+HHeatmap HeatmapCreate();
+void HeatmapDestroy(HHeatmap heatmap);
+void HeatmapBeginPass(HHeatmap heatmap, uint32_t width, uint32_t height);
+void HeatmapDrawOverlay(HHeatmap heatmap, const HeatmapSettings& settings, GLuint vertex_buffer, uint32_t width, uint32_t height);
@@ -0,0 +1,197 @@
+#include "includecache.h"
+
+#include "preprocessor.h"
+#include "utils.h"
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <unordered_map>
+#include <mutex>
+#include <cctype>
+
+struct IncludeCacheEntry {
+    std::shared_ptr<const IncludeFile> File;
+    std::filesystem::file_time_type ModificationTime;
+    uintmax_t Size;
+};
+
+struct IncludeCache {
+    std::mutex Mutex;
+    std::unordered_map<std::string, IncludeCacheEntry> Entries;
+    IncludeCacheStats Stats;
+};
+
+static IncludeCache& GetIncludeCache() {
+    static IncludeCache cache;
+    return cache;
+}
+
+static bool IsSpace(char c) {
+    return isspace((unsigned char)c) != 0;
+}
+
+static std::string_view Trim(std::string_view text) {
+    while (!text.empty() && IsSpace(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && IsSpace(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+static bool IsSignificant(std::string_view line) {
+    line = Trim(line);
+    return !line.empty() && line.substr(0, 2) != "//";
+}
+
+// Matches #include\s+"([^"]+)" anywhere in the line, the first occurrence that matches wins
+static bool FindInclude(std::string_view line, std::string_view& include) {
+    static const std::string_view directive = "#include";
+
+    for (size_t start = line.find(directive); start != std::string_view::npos; start = line.find(directive, start + 1)) {
+        size_t current = start + directive.size();
+        size_t spaces_start = current;
+        while (current < line.size() && IsSpace(line[current])) {
+            ++current;
+        }
+
+        if (current == spaces_start || current == line.size() || line[current] != '"') {
+            continue;
+        }
+
+        size_t path_end = line.find('"', current + 1);
+        if (path_end == std::string_view::npos || path_end == current + 1) {
+            continue;
+        }
+
+        include = line.substr(current + 1, path_end - current - 1);
+        return true;
+    }
+
+    return false;
+}
+
+// The whole file is inside #ifndef NAME / #define NAME ... #endif
+static bool HasIncludeGuard(const std::vector<std::string_view>& lines) {
+    size_t line = 0;
+    auto next_significant = [&]() {
+        while (line < lines.size() && !IsSignificant(lines[line])) {
+            ++line;
+        }
+        return line < lines.size();
+    };
+
+    std::string_view arguments;
+    if (!next_significant() || PreprocessorDirective(lines[line], arguments) != "ifndef") {
+        return false;
+    }
+    std::string_view guard = PreprocessorIdentifier(arguments);
+
+    ++line;
+    if (guard.empty() || !next_significant() || PreprocessorDirective(lines[line], arguments) != "define" || PreprocessorIdentifier(arguments) != guard) {
+        return false;
+    }
+
+    int32_t depth = 1;
+    for (++line; line < lines.size() && depth > 0; ++line) {
+        std::string_view name = PreprocessorDirective(lines[line], arguments);
+        if (name == "if" || name == "ifdef" || name == "ifndef") {
+            ++depth;
+        } else if (name == "endif") {
+            --depth;
+        }
+    }
+
+    return depth == 0 && !next_significant();
+}
+
+static std::shared_ptr<const IncludeFile> ParseIncludeFile(const std::string& path, const std::string& contents) {
+    std::shared_ptr<IncludeFile> file = std::make_shared<IncludeFile>();
+
+    std::error_code error;
+    std::filesystem::path canonical_path = std::filesystem::weakly_canonical(path, error);
+    file->CanonicalPath = error ? path : canonical_path.string();
+    file->Text.reserve(contents.size() + 1);
+
+    std::vector<std::string_view> lines;
+    std::string_view remaining = contents;
+    std::string_view line;
+    bool has_line = true;
+
+    // Every line, including the empty one following a final line feed, ends with a line feed
+    while (NextLine(remaining, line, has_line)) {
+        std::string_view include;
+        std::string_view arguments;
+
+        lines.push_back(line);
+
+        if (FindInclude(line, include)) {
+            file->Includes.push_back({file->Text.size(), std::string(include)});
+        } else if (PreprocessorDirective(line, arguments) == "pragma" && PreprocessorIdentifier(arguments) == "once") {
+            // Left empty so that the line count of the file does not change
+            file->IsOnce = true;
+            file->Text += '\n';
+        } else {
+            file->Text.append(line);
+            file->Text += '\n';
+        }
+    }
+
+    file->IsOnce |= HasIncludeGuard(lines);
+
+    return file;
+}
+
+bool IncludeCacheRead(const std::string& path, std::shared_ptr<const IncludeFile>& file) {
+    IncludeCache& cache = GetIncludeCache();
+
+    std::error_code error;
+    std::filesystem::file_time_type modification_time = std::filesystem::last_write_time(path, error);
+    uintmax_t size = error ? 0 : std::filesystem::file_size(path, error);
+    bool has_status = !error;
+
+    if (has_status) {
+        std::lock_guard<std::mutex> lock(cache.Mutex);
+        auto it = cache.Entries.find(path);
+        bool is_racy = std::filesystem::file_time_type::clock::now() - modification_time < std::chrono::seconds(2);
+        if (it != cache.Entries.end() && !is_racy && it->second.ModificationTime == modification_time && it->second.Size == size) {
+            ++cache.Stats.Hits;
+            file = it->second.File;
+            return true;
+        }
+    }
+
+    std::ifstream stream(path.c_str());
+    if (!stream.is_open()) {
+        return false;
+    }
+
+    std::ostringstream contents;
+    contents << stream.rdbuf();
+    file = ParseIncludeFile(path, contents.str());
+
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    ++cache.Stats.Reads;
+    if (has_status) {
+        cache.Entries[path] = {file, modification_time, size};
+    }
+
+    return true;
+}
+
+IncludeCacheStats IncludeCacheGetStats() {
+    IncludeCache& cache = GetIncludeCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    IncludeCacheStats stats = cache.Stats;
+    stats.Files = (uint32_t)cache.Entries.size();
+    return stats;
+}
+
+void IncludeCacheClear() {
+    IncludeCache& cache = GetIncludeCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    cache.Entries.clear();
+    cache.Stats = IncludeCacheStats();
+}
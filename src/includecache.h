@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdint.h>
+
+struct IncludeEdge {
+    // Position in the text where the included file is pasted
+    size_t Offset;
+    std::string Path;
+};
+
+// A shader file split at its #include lines. Files with #pragma once or an
+// include guard around their whole contents are pasted once per amalgamation.
+struct IncludeFile {
+    std::string Text;
+    std::vector<IncludeEdge> Includes;
+    std::string CanonicalPath;
+    bool IsOnce {false};
+};
+
+struct IncludeCacheStats {
+    uint32_t Files {0};
+    uint64_t Reads {0};
+    uint64_t Hits {0};
+};
+
+// Files are only read again when their modification time or size changed. Files
+// modified within the last seconds are always read, coarse timestamps could
+// otherwise hide a second edit.
+bool IncludeCacheRead(const std::string& path, std::shared_ptr<const IncludeFile>& file);
+IncludeCacheStats IncludeCacheGetStats();
+void IncludeCacheClear();
@@ -2,9 +2,15 @@
 
 #include "utils.h"
 #include "shaderparser.h"
+#include "glextensions.h"
+#include "programcache.h"
+#include "shadercompiler.h"
+#include "texturecache.h"
 
 #include <GLFW/glfw3.h>
 #include <atomic>
+#include <algorithm>
+#include <ctime>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb/stb_image_write.h>
@@ -17,61 +23,305 @@ void OnShaderChange(void* user_data, const char* file) {
     glfwPostEmptyEvent();
 }
 
+static void CheckResourceGrowth(LiveGLSL* live_glsl) {
+    // Resources not owned by the current render passes should stay constant across reloads
+    GLResourceStats unowned = GLResourceStatsSubtract(GLResourceGetStats(), RenderPassResourceStats(live_glsl->RenderPasses));
+    unowned.Count[EGLResourceTypeProgram] -= VariantCacheSize(live_glsl->Variants);
+    unowned = GLResourceStatsSubtract(unowned, TextureCacheResourceStats());
+    for (const PlaylistEntry& entry : live_glsl->Playlist) {
+        unowned = GLResourceStatsSubtract(unowned, RenderPassResourceStats(entry.Result.RenderPasses));
+    }
+
+    if (!live_glsl->HasResourceBaseline) {
+        live_glsl->ResourceBaseline = unowned;
+        live_glsl->HasResourceBaseline = true;
+        return;
+    }
+
+    std::string report;
+    if (GLResourceReportGrowth(live_glsl->ResourceBaseline, unowned, report)) {
+        fprintf(stderr, "GL resources grew across shader reload:\n%s", report.c_str());
+        live_glsl->ResourceBaseline = unowned;
+    }
+}
+
+static void OnShaderCompiled(void* user_data) {
+    glfwPostEmptyEvent();
+}
+
+static void OnTextureDecoded(void* user_data) {
+    glfwPostEmptyEvent();
+}
+
 void ReloadShaderIfChanged(LiveGLSL* live_glsl, std::string path, bool first_load = false) {
-    if (!live_glsl->ShaderFileChanged && !first_load) {
+    if (live_glsl->ShaderFileChanged.exchange(false) || first_load) {
+        ShaderCompileRequest request;
+        request.BasePath = live_glsl->BasePath;
+        request.Path = path;
+        request.Components = live_glsl->GUIComponents;
+        request.StripUnused = live_glsl->Args.StripUnused;
+
+        // The current passes are released on success, they do not count against the budget of the new ones
+        GLResourceStats reserved = GLResourceStatsSubtract(GLResourceGetStats(), RenderPassResourceStats(live_glsl->RenderPasses));
+        request.ReservedBytes = GLResourceTotalBytes(reserved);
+
+        ShaderCompilerSubmit(live_glsl->Compiler, request);
+    }
+
+    ShaderCompileResult result;
+    if (!ShaderCompilerPoll(live_glsl->Compiler, result)) {
         return;
     }
 
-    std::string read_file_error;
-    std::vector<RenderPass> render_passes;
-    std::vector<std::string> watches;
-    
+    if (result.Path != live_glsl->ShaderPath) {
+        // Another shader was opened while this one compiled
+        RenderPassReleaseReused(result.RenderPasses);
+        RenderPassDestroy(result.RenderPasses);
+        result = ShaderCompileResult();
+    }
+
     GUIClearLog(live_glsl->GUI);
 
-    if (!ShaderParserParse(live_glsl->BasePath, path, watches, render_passes, live_glsl->GUIComponents, read_file_error)) {
-        if (!read_file_error.empty()) {
-            GUILog(live_glsl->GUI, read_file_error);
+    if (result.Success) {
+        // The previous passes kept rendering until now, the new set replaces them in one step
+        RenderPassCreateFramebuffers(result.RenderPasses);
+        RenderPassDestroyReplaced(live_glsl->RenderPasses, result.RenderPasses);
+        ProfilerReset(live_glsl->Profiler);
+
+        live_glsl->RenderPasses = result.RenderPasses;
+        live_glsl->ShaderCompiled = true;
+
+        // Values edited while the new passes were compiling are kept
+        for (GUIComponent& component : result.Components) {
+            for (const GUIComponent& current : live_glsl->GUIComponents) {
+                if (current.UniformName == component.UniformName) {
+                    memcpy(&component.Data, &current.Data, sizeof(component.Data));
+                }
+            }
         }
-    } else {
-        std::string error;
-        live_glsl->ShaderCompiled = RenderPassCreate(render_passes, error);
+        live_glsl->GUIComponents = result.Components;
 
-        if (live_glsl->ShaderCompiled) {
-            RenderPassDestroy(live_glsl->RenderPasses);
+        live_glsl->Watches = result.Watches;
+        FileWatcherRemoveAllWatches(live_glsl->FileWatcher);
+
+        for (const auto& watch : result.Watches) {
+            FileWatcherAddWatch(live_glsl->FileWatcher, watch.c_str());
+        }
+    } else if (!result.Error.empty()) {
+        GUILog(live_glsl->GUI, result.Error);
+    }
+
+    ShaderCompilerSetCurrent(live_glsl->Compiler, live_glsl->RenderPasses);
 
-            live_glsl->RenderPasses = render_passes;
+    bool is_preloading = std::any_of(live_glsl->Playlist.begin(), live_glsl->Playlist.end(), [](const PlaylistEntry& entry) {
+        return entry.IsPending;
+    });
 
-            FileWatcherRemoveAllWatches(live_glsl->FileWatcher);
+    // Resources of a compilation still in flight would show up as growth
+    if (!ShaderCompilerIsBusy(live_glsl->Compiler) && live_glsl->PendingVariants.empty() && !is_preloading) {
+        CheckResourceGrowth(live_glsl);
+    }
+}
 
-            for (const auto& watch : watches) {
-                FileWatcherAddWatch(live_glsl->FileWatcher, watch.c_str());
+static std::string IniPath(const std::string& shader_path) {
+    return ExtractBasePath(shader_path) + "/" + ExtractFilenameWithoutExt(shader_path) + ".ini";
+}
+
+static void PlaylistSwitch(LiveGLSL* live_glsl, uint32_t index) {
+    PlaylistEntry& previous = live_glsl->Playlist[live_glsl->PlaylistIndex];
+    PlaylistEntry& entry = live_glsl->Playlist[index];
+
+    if (live_glsl->Args.EnableIni) {
+        GUIComponentSave(IniPath(live_glsl->ShaderPath), live_glsl->GUIComponents);
+    }
+
+    // The passes on screen stay loaded, going back to them is as fast as going forward
+    previous.Result = ShaderCompileResult();
+    previous.Result.Success = true;
+    previous.Result.Path = live_glsl->ShaderPath;
+    previous.Result.RenderPasses = std::move(live_glsl->RenderPasses);
+    previous.Result.Watches = live_glsl->Watches;
+    previous.Result.Components = live_glsl->GUIComponents;
+    previous.LoadTime = (int64_t)time(nullptr);
+    // A shader dropped on the window is not part of the playlist
+    previous.IsLoaded = live_glsl->ShaderCompiled && live_glsl->ShaderPath == previous.Path;
+    if (!previous.IsLoaded) {
+        RenderPassDestroy(previous.Result.RenderPasses);
+    }
+
+    RenderPassCreateFramebuffers(entry.Result.RenderPasses);
+    live_glsl->RenderPasses = std::move(entry.Result.RenderPasses);
+    live_glsl->GUIComponents = entry.Result.Components;
+    live_glsl->Watches = entry.Result.Watches;
+    live_glsl->ShaderPath = entry.Path;
+    live_glsl->Args.Input = entry.Path;
+    live_glsl->BasePath = ExtractBasePath(entry.Path);
+    live_glsl->ShaderCompiled = true;
+    live_glsl->PlaylistIndex = index;
+    live_glsl->PlaylistSwitchTime = glfwGetTime();
+
+    ProfilerReset(live_glsl->Profiler);
+    GUIClearLog(live_glsl->GUI);
+    ShaderCompilerSetCurrent(live_glsl->Compiler, live_glsl->RenderPasses);
+
+    FileWatcherRemoveAllWatches(live_glsl->FileWatcher);
+    for (const auto& watch : live_glsl->Watches) {
+        FileWatcherAddWatch(live_glsl->FileWatcher, watch.c_str());
+        // Files edited since the entry was loaded are not watched, they are picked up now
+        if (FileModificationTime(watch) >= entry.LoadTime) {
+            live_glsl->ShaderFileChanged.store(true);
+        }
+    }
+
+    entry.Result = ShaderCompileResult();
+    entry.IsLoaded = false;
+
+    std::string title = "live-glsl - " + ExtractFilenameWithoutExt(entry.Path) +
+        " (" + std::to_string(index + 1) + "/" + std::to_string(live_glsl->Playlist.size()) + ")";
+    glfwSetWindowTitle(live_glsl->GLFWWindowHandle, title.c_str());
+}
+
+static void PlaylistRequestSwitch(LiveGLSL* live_glsl, int32_t step) {
+    if (live_glsl->Playlist.size() < 2) {
+        return;
+    }
+
+    // Repeated requests move further from the entry being waited for
+    uint32_t from = live_glsl->PlaylistTarget >= 0 ? live_glsl->PlaylistTarget : live_glsl->PlaylistIndex;
+    uint32_t target = PlaylistNext(from, step, (uint32_t)live_glsl->Playlist.size());
+    live_glsl->PlaylistTarget = target != live_glsl->PlaylistIndex ? (int32_t)target : -1;
+    live_glsl->PlaylistStep = step;
+}
+
+static void PlaylistUpdate(LiveGLSL* live_glsl, double time) {
+    if (live_glsl->Playlist.empty()) {
+        return;
+    }
+
+    uint32_t count = (uint32_t)live_glsl->Playlist.size();
+
+    std::vector<ShaderCompileResult> results;
+    if (ShaderCompilerPollPreloads(live_glsl->Compiler, results)) {
+        for (ShaderCompileResult& result : results) {
+            for (PlaylistEntry& entry : live_glsl->Playlist) {
+                if (entry.IsPending && entry.Path == result.Path) {
+                    if (!result.Success) {
+                        fprintf(stderr, "Failed to preload %s: %s\n", result.Path.c_str(), result.Error.c_str());
+                    }
+                    entry.Result = std::move(result);
+                    entry.IsPending = false;
+                    entry.IsLoaded = true;
+                    break;
+                }
             }
-        } else if (!error.empty()) {
-            GUILog(live_glsl->GUI, error);
         }
+    }
 
-        glfwPostEmptyEvent();
+    if (live_glsl->Args.PlaylistInterval > 0.0f && live_glsl->PlaylistTarget < 0 &&
+        time - live_glsl->PlaylistSwitchTime >= live_glsl->Args.PlaylistInterval) {
+        PlaylistRequestSwitch(live_glsl, 1);
     }
 
-    live_glsl->ShaderFileChanged.store(false);
+    // A reload in flight may reuse objects of the passes on screen, the switch waits for it
+    while (live_glsl->PlaylistTarget >= 0 && !ShaderCompilerIsReloading(live_glsl->Compiler)) {
+        PlaylistEntry& target = live_glsl->Playlist[live_glsl->PlaylistTarget];
+        if (!target.IsLoaded) {
+            break;
+        }
+
+        if (target.Result.Success) {
+            PlaylistSwitch(live_glsl, live_glsl->PlaylistTarget);
+            live_glsl->PlaylistTarget = -1;
+            break;
+        }
+
+        // Shaders that fail to compile are skipped
+        PlaylistRequestSwitch(live_glsl, live_glsl->PlaylistStep);
+    }
+
+    uint32_t center = live_glsl->PlaylistTarget >= 0 ? live_glsl->PlaylistTarget : live_glsl->PlaylistIndex;
+    std::vector<uint32_t> near = PlaylistNearEntries(center, count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        PlaylistEntry& entry = live_glsl->Playlist[i];
+        bool is_near = std::find(near.begin(), near.end(), i) != near.end();
+
+        // A failed entry is tried again once its file changes
+        bool is_stale = entry.IsLoaded && !entry.Result.Success && FileModificationTime(entry.Path) >= entry.LoadTime;
+
+        if (entry.IsLoaded && (!is_near || is_stale)) {
+            RenderPassDestroy(entry.Result.RenderPasses);
+            entry.Result = ShaderCompileResult();
+            entry.IsLoaded = false;
+        }
+    }
+
+    for (uint32_t index : near) {
+        PlaylistEntry& entry = live_glsl->Playlist[index];
+        if (index == live_glsl->PlaylistIndex || entry.IsLoaded || entry.IsPending) {
+            continue;
+        }
+
+        ShaderCompileRequest request;
+        request.BasePath = ExtractBasePath(entry.Path);
+        request.Path = entry.Path;
+        request.StripUnused = live_glsl->Args.StripUnused;
+        if (live_glsl->Args.EnableIni) {
+            GUIComponentLoad(IniPath(entry.Path), request.Components);
+        }
+
+        entry.LoadTime = (int64_t)::time(nullptr);
+        entry.IsPending = true;
+        ShaderCompilerSubmitPreload(live_glsl->Compiler, request);
+    }
 }
 
 LiveGLSL* LiveGLSLCreate(const Arguments& args) {
+    std::vector<PlaylistEntry> playlist;
+    uint32_t playlist_index = 0;
+    if (!args.Playlist.empty()) {
+        std::string error;
+        if (!PlaylistLoad(args.Playlist, playlist, error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return nullptr;
+        }
+
+        // An input from the playlist is shown first
+        while (playlist_index < playlist.size() && playlist[playlist_index].Path != args.Input) {
+            ++playlist_index;
+        }
+        playlist_index = playlist_index < playlist.size() ? playlist_index : 0;
+    }
+
     LiveGLSL* live_glsl = new LiveGLSL();
 
     live_glsl->ShaderFileChanged.store(false);
     live_glsl->FileWatcher = FileWatcherCreate(OnShaderChange, live_glsl, 16);
     live_glsl->ShaderCompiled = false;
-    live_glsl->ShaderPath = args.Input;
+    live_glsl->ShaderPath = playlist.empty() ? args.Input : playlist[playlist_index].Path;
+    live_glsl->Playlist = std::move(playlist);
+    live_glsl->PlaylistIndex = playlist_index;
+    live_glsl->PlaylistTarget = -1;
+    live_glsl->PlaylistStep = 1;
+    live_glsl->PlaylistSwitchTime = 0.0;
     live_glsl->WindowWidth = args.Width;
     live_glsl->WindowHeight = args.Height;
     live_glsl->IsContinuousRendering = false;
+    live_glsl->IsFocused = true;
+    live_glsl->IsIconified = false;
+    live_glsl->HasResourceBaseline = false;
+    live_glsl->IsFrozen = false;
+    live_glsl->FreezeValuesHash = 0;
+    live_glsl->FreezeValuesTime = 0.0;
+    live_glsl->FreezeSettleTime = 0.0;
     live_glsl->Args = args;
-    live_glsl->BasePath = ExtractBasePath(args.Input);
-    
+    live_glsl->Args.Input = live_glsl->ShaderPath;
+    live_glsl->BasePath = ExtractBasePath(live_glsl->ShaderPath);
+
+    GLResourceSetBudget((int64_t)args.MemoryBudgetMB * 1024 * 1024);
+
     if (live_glsl->Args.EnableIni) {
-        std::string shader_name = ExtractFilenameWithoutExt(args.Input);
-        GUIComponentLoad(live_glsl->BasePath + "/" + shader_name + ".ini", live_glsl->GUIComponents);
+        GUIComponentLoad(IniPath(live_glsl->ShaderPath), live_glsl->GUIComponents);
     }
 
     // Init GLFW Window
@@ -114,9 +364,42 @@ LiveGLSL* LiveGLSLCreate(const Arguments& args) {
             GUIResize(live_glsl->GUI, window_width, window_height);
         });
 
+        glfwSetWindowFocusCallback(live_glsl->GLFWWindowHandle, [](GLFWwindow* window, int focused) {
+            LiveGLSL* live_glsl = static_cast<LiveGLSL*>(glfwGetWindowUserPointer(window));
+            live_glsl->IsFocused = focused == GLFW_TRUE;
+        });
+
+        glfwSetWindowIconifyCallback(live_glsl->GLFWWindowHandle, [](GLFWwindow* window, int iconified) {
+            LiveGLSL* live_glsl = static_cast<LiveGLSL*>(glfwGetWindowUserPointer(window));
+            live_glsl->IsIconified = iconified == GLFW_TRUE;
+        });
+
         glfwSetKeyCallback(live_glsl->GLFWWindowHandle, [](GLFWwindow* window, int key, int scancode, int action, int mods) {
+            LiveGLSL* live_glsl = static_cast<LiveGLSL*>(glfwGetWindowUserPointer(window));
             if (key == GLFW_KEY_ESCAPE) glfwSetWindowShouldClose(window, GL_TRUE);
-            GUIKeyCallback(window, key, scancode, action, mods);
+            if (action == GLFW_PRESS) {
+                switch (key) {
+                    case GLFW_KEY_F1:
+                        GUIToggleTools(live_glsl->GUI);
+                        break;
+                    case GLFW_KEY_SPACE:
+                        FrameClockSetPaused(live_glsl->Clock, !live_glsl->Clock.IsPaused);
+                        break;
+                    case GLFW_KEY_RIGHT:
+                        FrameClockStep(live_glsl->Clock);
+                        break;
+                    case GLFW_KEY_HOME:
+                        FrameClockSeek(live_glsl->Clock, 0.0);
+                        break;
+                    case GLFW_KEY_PAGE_DOWN:
+                        PlaylistRequestSwitch(live_glsl, 1);
+                        break;
+                    case GLFW_KEY_PAGE_UP:
+                        PlaylistRequestSwitch(live_glsl, -1);
+                        break;
+                }
+            }
+            GUIKeyCallback(live_glsl->GUI, key, scancode, action, mods);
         });
 
         glfwSetDropCallback(live_glsl->GLFWWindowHandle, [](GLFWwindow* window, int count, const char** paths) {
@@ -141,12 +424,27 @@ LiveGLSL* LiveGLSLCreate(const Arguments& args) {
         glfwGetFramebufferSize(live_glsl->GLFWWindowHandle, &fb_width, &fb_height);
         live_glsl->PixelDensity = (float)fb_width / (float)live_glsl->WindowWidth;
         gladLoadGL(glfwGetProcAddress);
+        GLExtensionsLoad(glfwGetProcAddress);
         glfwSwapInterval(1);
     }
 
-    live_glsl->GUI = GUIInit(live_glsl->GLFWWindowHandle, args.Width, args.Height);
+    if (args.EnableCache) {
+        std::string cache_directory = args.CacheDirectory.empty() ? DefaultCacheDirectory() : args.CacheDirectory;
+        ProgramCacheSetDirectory(cache_directory);
+        TextureFileSetDirectory(cache_directory + PATH_DELIMITER + "textures");
+    }
+    TextureCacheSetBudget((int64_t)args.TextureCacheMB * 1024 * 1024);
+    // An offline frame needs every texture complete
+    TextureCacheSetUploadBudget(args.Output.empty() ? (int64_t)args.UploadBudgetMB * 1024 * 1024 : 0);
 
-    ReloadShaderIfChanged(live_glsl, args.Input, true);
+    live_glsl->Clock.FixedTimestep = args.FixedTimestep;
+    FrameClockSetPaused(live_glsl->Clock, args.StartPaused);
+    FrameClockReset(live_glsl->Clock, glfwGetTime(), args.StartTime);
+
+    live_glsl->GUI = GUIInit(live_glsl->GLFWWindowHandle, args.Width, args.Height);
+    live_glsl->Profiler = ProfilerCreate();
+    live_glsl->Heatmap = HeatmapCreate();
+    ProfilerSetStatistics(live_glsl->Profiler, args.PipelineStatistics);
 
     // Init GL
     {
@@ -160,57 +458,463 @@ LiveGLSL* LiveGLSLCreate(const Arguments& args) {
              1.0f, -1.0f,
         };
 
-        glGenVertexArrays(1, &live_glsl->VaoId);
+        live_glsl->VaoId = GLResourceCreate(EGLResourceTypeVertexArray);
         glBindVertexArray(live_glsl->VaoId);
-        glGenBuffers(1, &live_glsl->VertexBufferId);
+        live_glsl->VertexBufferId = GLResourceCreate(EGLResourceTypeBuffer);
         glBindBuffer(GL_ARRAY_BUFFER, live_glsl->VertexBufferId);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        GLResourceDescribe(EGLResourceTypeBuffer, live_glsl->VertexBufferId, GLResourceBufferInfo("", "fullscreen quad", sizeof(vertices)));
     }
 
+    live_glsl->Variants = VariantCacheCreate(64);
+    live_glsl->Compiler = ShaderCompilerCreate(live_glsl->GLFWWindowHandle, args.CompilerThreads, OnShaderCompiled, live_glsl);
+    TextureCacheSetDecodedCallback(OnTextureDecoded, live_glsl);
+
+    ReloadShaderIfChanged(live_glsl, live_glsl->ShaderPath, true);
+    live_glsl->PlaylistSwitchTime = glfwGetTime();
+
     return live_glsl;
 }
 
 void LiveGLSLDestroy(LiveGLSL* live_glsl) {
-    if (live_glsl->VertexBufferId) {
-        glDeleteBuffers(1, &live_glsl->VertexBufferId);
-    }
+    GLResourceDestroy(EGLResourceTypeBuffer, live_glsl->VertexBufferId);
+    GLResourceDestroy(EGLResourceTypeVertexArray, live_glsl->VaoId);
 
-    if (live_glsl->VaoId) {
-        glDeleteVertexArrays(1, &live_glsl->VaoId);
-    }
-    
     if (live_glsl->Args.EnableIni) {
-        std::string shader_name = ExtractFilenameWithoutExt(live_glsl->ShaderPath);
-        GUIComponentSave(live_glsl->BasePath + "/" + shader_name + ".ini", live_glsl->GUIComponents);
+        GUIComponentSave(IniPath(live_glsl->ShaderPath), live_glsl->GUIComponents);
+    }
+
+    if (!live_glsl->Args.TimingsOutput.empty() && !ProfilerExport(live_glsl->Profiler, live_glsl->Args.TimingsOutput)) {
+        fprintf(stderr, "Failed to write timings to file: %s\n", live_glsl->Args.TimingsOutput.c_str());
     }
 
+    ShaderCompilerDestroy(live_glsl->Compiler);
+    VariantCacheDestroy(live_glsl->Variants);
+    for (PlaylistEntry& entry : live_glsl->Playlist) {
+        RenderPassDestroy(entry.Result.RenderPasses);
+    }
     RenderPassDestroy(live_glsl->RenderPasses);
+    TextureCacheSetDecodedCallback(nullptr, nullptr);
+    TextureCacheClear();
     FileWatcherDestroy(live_glsl->FileWatcher);
+    ProfilerDestroy(live_glsl->Profiler);
+    HeatmapDestroy(live_glsl->Heatmap);
     GUIDestroy(live_glsl->GUI);
 
     delete live_glsl;
 
+    std::string report;
+    if (GLResourceReportGrowth(GLResourceStats(), GLResourceGetStats(), report)) {
+        fprintf(stderr, "GL resources still alive on exit:\n%s", report.c_str());
+    }
+
     glfwTerminate();
 }
 
-int LiveGLSLRender(LiveGLSL* live_glsl) {
-    double previous_time = glfwGetTime();
-    uint32_t frame_count = 0;
+static bool IsWindowHidden(LiveGLSL* live_glsl) {
+    if (live_glsl->IsIconified || !glfwGetWindowAttrib(live_glsl->GLFWWindowHandle, GLFW_VISIBLE)) {
+        return true;
+    }
+
+    // Some platforms report an empty framebuffer instead of an iconify event when the window is occluded
+    int fb_width = 0;
+    int fb_height = 0;
+    glfwGetFramebufferSize(live_glsl->GLFWWindowHandle, &fb_width, &fb_height);
+
+    return fb_width == 0 || fb_height == 0;
+}
+
+static void WaitForNextFrame(LiveGLSL* live_glsl, double frame_start_time) {
+    if (!live_glsl->IsContinuousRendering) {
+        // Textures streaming in need the next frames
+        if (TextureCacheIsUploading()) {
+            glfwPollEvents();
+            return;
+        }
+
+        // Wake up once the GUI values settle, frozen variants are only requested then
+        // and for the next timed playlist switch, a switch waiting for its shader wakes up with the compiler
+        double wake_time = live_glsl->FreezeSettleTime;
+        if (live_glsl->Args.PlaylistInterval > 0.0f && live_glsl->PlaylistTarget < 0 && live_glsl->Playlist.size() > 1) {
+            double switch_time = live_glsl->PlaylistSwitchTime + live_glsl->Args.PlaylistInterval;
+            wake_time = wake_time > 0.0 ? std::min(wake_time, switch_time) : switch_time;
+        }
+
+        double remaining = wake_time - glfwGetTime();
+        if (wake_time > 0.0 && remaining > 0.0) {
+            glfwWaitEventsTimeout(remaining);
+        } else {
+            glfwWaitEvents();
+        }
+        return;
+    }
+
+    while (!glfwWindowShouldClose(live_glsl->GLFWWindowHandle) && !live_glsl->ShaderFileChanged) {
+        uint32_t max_fps = live_glsl->IsFocused ? live_glsl->Args.MaxFPS : live_glsl->Args.UnfocusedFPS;
+        if (max_fps == 0) {
+            glfwPollEvents();
+            return;
+        }
+
+        // Keep processing input while waiting, the focus may change and unlock a higher rate
+        double remaining = frame_start_time + 1.0 / max_fps - glfwGetTime();
+        if (remaining <= 0.0) {
+            glfwPollEvents();
+            return;
+        }
+
+        glfwWaitEventsTimeout(remaining);
+    }
+}
+
+static void BindPassUniforms(LiveGLSL* live_glsl, const RenderPass& render_pass, GLuint program, uint32_t width, uint32_t height) {
+    double x, y;
+    glfwGetCursorPos(live_glsl->GLFWWindowHandle, &x, &y);
+    x *= live_glsl->PixelDensity;
+    y *= live_glsl->PixelDensity;
+
+    int mouse_left_state = glfwGetMouseButton(live_glsl->GLFWWindowHandle, GLFW_MOUSE_BUTTON_LEFT);
+
+    glUniform2f(glGetUniformLocation(program, "resolution"), width, height);
+    glUniform1f(glGetUniformLocation(program, "time"), live_glsl->Clock.Time);
+    glUniform1f(glGetUniformLocation(program, "pixel_ratio"), live_glsl->PixelDensity);
+    // Mouse position, x relative to left, y relative to top
+    glUniform3f(glGetUniformLocation(program, "mouse"), x, y, mouse_left_state == GLFW_PRESS ? 1.0f : 0.0f);
+
+    int texture_unit = 0;
+
+    if (!render_pass.Input.empty()) {
+        for (const auto& other : live_glsl->RenderPasses) {
+            if (other.Output == render_pass.Input) {
+                glActiveTexture(GL_TEXTURE0 + texture_unit);
+                glBindTexture(GL_TEXTURE_2D, other.TextureId);
+                glUniform1i(glGetUniformLocation(program, render_pass.Input.c_str()), texture_unit);
+                glUniform2f(glGetUniformLocation(program, (render_pass.Input + "_resolution").c_str()), other.Width, other.Height);
+                ++texture_unit;
+            }
+        }
+    }
 
+    for (const GUIComponent& gui_component : live_glsl->GUIComponents) {
+        if (GUIIsDefineType(gui_component.Type)) {
+            continue;
+        }
+
+        GLuint uniform_location = glGetUniformLocation(program, gui_component.UniformName.c_str());
+        switch (gui_component.UniformType) {
+            case EGUIUniformTypeFloat:
+                glUniform1f(uniform_location, gui_component.Data[0]);
+                break;
+            case EGUIUniformTypeVec2:
+                glUniform2f(uniform_location, gui_component.Data[0], gui_component.Data[1]);
+                break;
+            case EGUIUniformTypeVec3:
+                glUniform3f(uniform_location, gui_component.Data[0], gui_component.Data[1], gui_component.Data[2]);
+                break;
+            case EGUIUniformTypeVec4:
+                glUniform4f(uniform_location, gui_component.Data[0], gui_component.Data[1], gui_component.Data[2], gui_component.Data[3]);
+                break;
+        }
+    }
+
+    for (const Texture& texture : render_pass.Textures) {
+        glActiveTexture(GL_TEXTURE0 + texture_unit);
+        glBindTexture(GL_TEXTURE_2D, texture.Image->Id);
+        glUniform1i(glGetUniformLocation(program, texture.Binding.c_str()), texture_unit);
+        glUniform2f(glGetUniformLocation(program, (texture.Binding + "_resolution").c_str()), texture.Width, texture.Height);
+        ++texture_unit;
+    }
+}
+
+static uint64_t GUIValuesHash(const std::vector<GUIComponent>& components, uint64_t hash) {
+    for (const GUIComponent& component : components) {
+        hash = HashFNV1a(component.UniformName, hash);
+        hash = HashFNV1aBytes(component.Data, sizeof(component.Data), hash);
+    }
+    return hash;
+}
+
+static bool IsDefineInPass(const RenderPass& render_pass, const GUIComponent& component) {
+    return GUIIsDefineType(component.Type) &&
+        std::find(render_pass.Defines.begin(), render_pass.Defines.end(), component.UniformName) != render_pass.Defines.end();
+}
+
+// Returns 0 when every define of the pass has its value from the source, the pass program is that variant
+static uint64_t DefineVariantKey(const RenderPass& render_pass, const std::vector<GUIComponent>& components) {
+    uint64_t hash = HashFNV1a("defines", render_pass.Hash);
+    bool is_default = true;
+    for (const GUIComponent& component : components) {
+        if (!IsDefineInPass(render_pass, component)) {
+            continue;
+        }
+        is_default &= (uint32_t)component.Data[0] == component.Define.Default;
+        hash = HashFNV1a(component.UniformName, hash);
+        hash = HashFNV1aBytes(&component.Data[0], sizeof(float), hash);
+    }
+    return is_default ? 0 : hash;
+}
+
+static bool IsVariantKnown(LiveGLSL* live_glsl, uint64_t key) {
+    return live_glsl->PendingVariants.count(key) || live_glsl->UnavailableVariants.count(key) ||
+        VariantCacheContains(live_glsl->Variants, key);
+}
+
+static std::string DefinesSource(const RenderPass& render_pass, const std::vector<GUIComponent>& components) {
+    std::string source;
+    if (!ShaderParserApplyDefines(render_pass.ShaderSource, components, source)) {
+        return render_pass.ShaderSource;
+    }
+    return source;
+}
+
+static GLuint PassProgram(LiveGLSL* live_glsl, RenderPass& render_pass) {
+    // Any control touched since the variant was built changes the key, and falls back to the uniform driven program
+    ShaderProgram variant;
+    if (live_glsl->IsFrozen && VariantCacheFind(live_glsl->Variants, GUIValuesHash(live_glsl->GUIComponents, render_pass.Hash), variant)) {
+        return variant.Handle;
+    }
+
+    uint64_t define_key = DefineVariantKey(render_pass, live_glsl->GUIComponents);
+    if (define_key == 0) {
+        render_pass.DefineVariantKey = 0;
+        return render_pass.Program.Handle;
+    }
+
+    if (VariantCacheFind(live_glsl->Variants, define_key, variant)) {
+        render_pass.DefineVariantKey = define_key;
+        return variant.Handle;
+    }
+
+    if (render_pass.DefineVariantKey != 0 && VariantCacheFind(live_glsl->Variants, render_pass.DefineVariantKey, variant)) {
+        return variant.Handle;
+    }
+    return render_pass.Program.Handle;
+}
+
+static void RequestVariant(LiveGLSL* live_glsl, uint64_t key, const std::string& fragment_source, std::vector<ShaderVariantRequest>& requests) {
+    ShaderVariantRequest request;
+    request.Key = key;
+    request.FragmentSource = fragment_source;
+    live_glsl->PendingVariants.insert(key);
+    requests.push_back(request);
+}
+
+static void RequestDefineNeighbours(LiveGLSL* live_glsl, std::vector<ShaderVariantRequest>& requests) {
+    // Every other value of a single define is one click away, bound the count so that they fit in the cache
+    const uint32_t max_neighbours = 32;
+    uint32_t neighbours = 0;
+
+    for (const auto& render_pass : live_glsl->RenderPasses) {
+        std::vector<GUIComponent> components = live_glsl->GUIComponents;
+        for (GUIComponent& component : components) {
+            if (!IsDefineInPass(render_pass, component)) {
+                continue;
+            }
+
+            float current = component.Data[0];
+            for (uint32_t value = 0; value < GUIDefineValues(component); ++value) {
+                if (value == (uint32_t)current) {
+                    continue;
+                }
+                if (neighbours++ == max_neighbours) {
+                    return;
+                }
+
+                component.Data[0] = (float)value;
+                uint64_t key = DefineVariantKey(render_pass, components);
+                if (key != 0 && !IsVariantKnown(live_glsl, key)) {
+                    RequestVariant(live_glsl, key, DefinesSource(render_pass, components), requests);
+                }
+            }
+            component.Data[0] = current;
+        }
+    }
+}
+
+static uint64_t HeatmapVariantKey(const RenderPass& render_pass) {
+    return HashFNV1a("heatmap", render_pass.Hash);
+}
+
+// The pass may have been reloaded since the instrumented variant was requested
+static void AcceptHeatmapProgram(LiveGLSL* live_glsl, ShaderVariantResult& result) {
+    for (auto& render_pass : live_glsl->RenderPasses) {
+        if (HeatmapVariantKey(render_pass) != result.Key || render_pass.HeatmapProgram.Handle != 0 || !render_pass.HeatmapError.empty()) {
+            continue;
+        }
+
+        if (result.Success) {
+            render_pass.HeatmapProgram = result.Program;
+        } else {
+            render_pass.HeatmapError = result.Error;
+            fprintf(stderr, "Failed to instrument render pass %s: %s\n", RenderPassName(render_pass).c_str(), result.Error.c_str());
+        }
+        return;
+    }
+
+    ShaderProgramDestroy(result.Program);
+}
+
+static void UpdateVariants(LiveGLSL* live_glsl, double time) {
+    std::vector<ShaderVariantResult> results;
+    if (ShaderCompilerPollVariants(live_glsl->Compiler, results)) {
+        for (ShaderVariantResult& result : results) {
+            live_glsl->PendingVariants.erase(result.Key);
+            if (live_glsl->HeatmapVariants.erase(result.Key)) {
+                AcceptHeatmapProgram(live_glsl, result);
+            } else if (result.Success) {
+                VariantCacheInsert(live_glsl->Variants, result.Key, result.Program);
+            } else {
+                live_glsl->UnavailableVariants.insert(result.Key);
+                fprintf(stderr, "Failed to compile variant: %s\n", result.Error.c_str());
+            }
+        }
+    }
+
+    live_glsl->FreezeSettleTime = 0.0;
+    if (!live_glsl->ShaderCompiled) {
+        return;
+    }
+
+    std::vector<ShaderVariantRequest> requests;
+
+    // The selected define values are needed right away
+    for (const auto& render_pass : live_glsl->RenderPasses) {
+        uint64_t key = DefineVariantKey(render_pass, live_glsl->GUIComponents);
+        if (key != 0 && !IsVariantKnown(live_glsl, key)) {
+            RequestVariant(live_glsl, key, DefinesSource(render_pass, live_glsl->GUIComponents), requests);
+        }
+    }
+
+    // Values change every frame while a control is dragged, wait for them to settle before compiling
+    uint64_t values_hash = GUIValuesHash(live_glsl->GUIComponents, 0);
+    if (values_hash != live_glsl->FreezeValuesHash) {
+        live_glsl->FreezeValuesHash = values_hash;
+        live_glsl->FreezeValuesTime = time;
+    }
+
+    if (live_glsl->IsFrozen && time - live_glsl->FreezeValuesTime < 0.5) {
+        live_glsl->FreezeSettleTime = live_glsl->FreezeValuesTime + 0.5;
+    } else if (live_glsl->IsFrozen) {
+        for (const auto& render_pass : live_glsl->RenderPasses) {
+            uint64_t key = GUIValuesHash(live_glsl->GUIComponents, render_pass.Hash);
+            if (IsVariantKnown(live_glsl, key)) {
+                continue;
+            }
+
+            std::string frozen;
+            if (!ShaderParserFreeze(DefinesSource(render_pass, live_glsl->GUIComponents), live_glsl->GUIComponents, frozen)) {
+                // Nothing to bake in this pass, the uniform driven program is already the best one
+                live_glsl->UnavailableVariants.insert(key);
+                continue;
+            }
+
+            RequestVariant(live_glsl, key, frozen, requests);
+        }
+    }
+
+    // Only compile ahead once nothing on screen is waiting for the compiler
+    if (requests.empty() && live_glsl->PendingVariants.empty()) {
+        RequestDefineNeighbours(live_glsl, requests);
+    }
+
+    if (!requests.empty()) {
+        ShaderCompilerSubmitVariants(live_glsl->Compiler, requests);
+    }
+}
+
+static void RequestHeatmapPrograms(LiveGLSL* live_glsl) {
+    // Instrumented variants are only built once the heatmap is shown, on the compiler
+    // thread like the other variants, and kept until the next reload
+    std::vector<ShaderVariantRequest> requests;
+    for (auto& render_pass : live_glsl->RenderPasses) {
+        uint64_t key = HeatmapVariantKey(render_pass);
+        if (render_pass.HeatmapProgram.Handle != 0 || !render_pass.HeatmapError.empty() || live_glsl->HeatmapVariants.count(key)) {
+            continue;
+        }
+
+        std::string instrumented;
+        if (!ShaderParserInstrument(render_pass.ShaderSource, instrumented, render_pass.HeatmapError)) {
+            fprintf(stderr, "Failed to instrument render pass %s: %s\n", RenderPassName(render_pass).c_str(), render_pass.HeatmapError.c_str());
+            continue;
+        }
+
+        live_glsl->HeatmapVariants.insert(key);
+        RequestVariant(live_glsl, key, instrumented, requests);
+    }
+
+    if (!requests.empty()) {
+        ShaderCompilerSubmitVariants(live_glsl->Compiler, requests);
+    }
+}
+
+static void RenderHeatmap(LiveGLSL* live_glsl) {
+    const HeatmapSettings& settings = live_glsl->HeatmapView;
+    if (settings.PassIndex >= live_glsl->RenderPasses.size()) {
+        return;
+    }
+
+    const RenderPass& render_pass = live_glsl->RenderPasses[settings.PassIndex];
+    GLuint program = render_pass.HeatmapProgram.Handle;
+    if (program == 0) {
+        return;
+    }
+
+    uint32_t window_width = live_glsl->WindowWidth * live_glsl->PixelDensity;
+    uint32_t window_height = live_glsl->WindowHeight * live_glsl->PixelDensity;
+    uint32_t width = render_pass.IsMain ? window_width : render_pass.Width * live_glsl->PixelDensity;
+    uint32_t height = render_pass.IsMain ? window_height : render_pass.Height * live_glsl->PixelDensity;
+
+    HeatmapBeginPass(live_glsl->Heatmap, width, height);
+
+    glUseProgram(program);
+    BindPassUniforms(live_glsl, render_pass, program, width, height);
+
+    glBindVertexArray(live_glsl->VaoId);
+    glBindBuffer(GL_ARRAY_BUFFER, live_glsl->VertexBufferId);
+    GLint position_attrib = glGetAttribLocation(program, "position");
+    glVertexAttribPointer(position_attrib, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), 0);
+    glEnableVertexAttribArray(position_attrib);
+
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    HeatmapDrawOverlay(live_glsl->Heatmap, settings, live_glsl->VertexBufferId, window_width, window_height);
+}
+
+int LiveGLSLRender(LiveGLSL* live_glsl) {
     while (!glfwWindowShouldClose(live_glsl->GLFWWindowHandle)) {
-        ReloadShaderIfChanged(live_glsl, live_glsl->ShaderPath);
+        if (IsWindowHidden(live_glsl) && live_glsl->Args.Output.empty()) {
+            // Nothing is visible, sleep until the window is restored
+            glfwWaitEvents();
+            continue;
+        }
+
+        double frame_start_time = glfwGetTime();
 
-        double x, y;
-        glfwGetCursorPos(live_glsl->GLFWWindowHandle, &x, &y);
-        x *= live_glsl->PixelDensity;
-        y *= live_glsl->PixelDensity;
+        // Sample the time once so that every pass of the frame sees the same value
+        FrameClockTick(live_glsl->Clock, frame_start_time);
 
-        int mouse_left_state = glfwGetMouseButton(live_glsl->GLFWWindowHandle, GLFW_MOUSE_BUTTON_LEFT);
+        ReloadShaderIfChanged(live_glsl, live_glsl->ShaderPath);
+        PlaylistUpdate(live_glsl, frame_start_time);
+
+        // Shaders go live with placeholders, an offline frame needs every texture
+        if (live_glsl->ShaderCompiled && !live_glsl->Args.Output.empty()) {
+            for (const auto& render_pass : live_glsl->RenderPasses) {
+                for (const auto& texture : render_pass.Textures) {
+                    TextureCacheWait(*texture.Image);
+                }
+            }
+        }
+        TextureCacheUpdate();
+        UpdateVariants(live_glsl, frame_start_time);
 
         if (live_glsl->ShaderCompiled) {
             for (GUIComponent& gui_component : live_glsl->GUIComponents) {
                 gui_component.IsInUse = false;
                 for (const auto& render_pass : live_glsl->RenderPasses) {
+                    if (GUIIsDefineType(gui_component.Type)) {
+                        gui_component.IsInUse |= IsDefineInPass(render_pass, gui_component);
+                        continue;
+                    }
                     GLuint uniform_location = glGetUniformLocation(render_pass.Program.Handle, gui_component.UniformName.c_str());
                     gui_component.IsInUse |= uniform_location != -1;
                 }
@@ -230,93 +934,76 @@ int LiveGLSLRender(LiveGLSL* live_glsl) {
                 GUITexture guiTexture;
                 guiTexture.Width = texture.Width;
                 guiTexture.Height = texture.Height;
-                guiTexture.Id = texture.Id;
+                guiTexture.Id = texture.Image->Id;
                 textures.push_back(guiTexture);
             }
         }
 
-        GUINewFrame(live_glsl->GUI, live_glsl->GUIComponents, textures);
+        GUITools tools;
+        tools.Clock = &live_glsl->Clock;
+        tools.Profiler = live_glsl->Profiler;
+        tools.Heatmap = &live_glsl->HeatmapView;
+        tools.Freeze = &live_glsl->IsFrozen;
+        for (const auto& render_pass : live_glsl->RenderPasses) {
+            tools.PassNames.push_back(RenderPassName(render_pass));
+        }
+        if (live_glsl->HeatmapView.PassIndex < live_glsl->RenderPasses.size()) {
+            tools.HeatmapError = live_glsl->RenderPasses[live_glsl->HeatmapView.PassIndex].HeatmapError;
+        }
+        tools.ExportPath = ExtractFilenameWithoutExt(live_glsl->ShaderPath) + "_timings";
+        if (!live_glsl->BasePath.empty()) {
+            tools.ExportPath = live_glsl->BasePath + PATH_DELIMITER + tools.ExportPath;
+        }
+
+        GUINewFrame(live_glsl->GUI, live_glsl->GUIComponents, textures, tools);
 
         if (live_glsl->ShaderCompiled) {
-            for (const auto& render_pass : live_glsl->RenderPasses) {
+            ProfilerBeginFrame(live_glsl->Profiler);
+
+            for (auto& render_pass : live_glsl->RenderPasses) {
                 uint32_t width = render_pass.IsMain ? live_glsl->WindowWidth : render_pass.Width;
                 uint32_t height = render_pass.IsMain ? live_glsl->WindowHeight : render_pass.Height;
 
                 width *= live_glsl->PixelDensity;
                 height *= live_glsl->PixelDensity;
 
+                ProfilerBeginPass(live_glsl->Profiler, RenderPassName(render_pass), (uint64_t)width * height);
+
                 glBindFramebuffer(GL_FRAMEBUFFER, render_pass.FBO);
                 glClear(GL_COLOR_BUFFER_BIT);
 
-                assert(render_pass.Program.Handle != 0);
-                glUseProgram(render_pass.Program.Handle);
+                GLuint program = PassProgram(live_glsl, render_pass);
+                assert(program != 0);
+                glUseProgram(program);
 
                 glBindBuffer(GL_ARRAY_BUFFER, live_glsl->VertexBufferId);
                 glViewport(0, 0, width, height);
 
-                glUniform2f(glGetUniformLocation(render_pass.Program.Handle, "resolution"), width, height);
-                glUniform1f(glGetUniformLocation(render_pass.Program.Handle, "time"), glfwGetTime());
-                glUniform1f(glGetUniformLocation(render_pass.Program.Handle, "pixel_ratio"), live_glsl->PixelDensity);
-                // Mouse position, x relative to left, y relative to top
-                glUniform3f(glGetUniformLocation(render_pass.Program.Handle, "mouse"), x, y, mouse_left_state == GLFW_PRESS ? 1.0f : 0.0f);
-
-                int texture_unit = 0;
-
-                if (!render_pass.Input.empty()) {
-                    for (const auto& other : live_glsl->RenderPasses) {
-                        if (other.Output == render_pass.Input) {
-                            glActiveTexture(GL_TEXTURE0 + texture_unit);
-                            glBindTexture(GL_TEXTURE_2D, other.TextureId);
-                            glUniform1i(glGetUniformLocation(render_pass.Program.Handle, render_pass.Input.c_str()), texture_unit);
-                            glUniform2f(glGetUniformLocation(render_pass.Program.Handle, (render_pass.Input + "_resolution").c_str()), other.Width, other.Height);
-                            ++texture_unit;
-                        }
-                    }
-                }
-
-                for (const GUIComponent& gui_component : live_glsl->GUIComponents) {
-                    GLuint uniform_location = glGetUniformLocation(render_pass.Program.Handle, gui_component.UniformName.c_str());
-                    switch (gui_component.UniformType) {
-                        case EGUIUniformTypeFloat:
-                            glUniform1f(uniform_location, gui_component.Data[0]);
-                            break;
-                        case EGUIUniformTypeVec2:
-                            glUniform2f(uniform_location, gui_component.Data[0], gui_component.Data[1]);
-                            break;
-                        case EGUIUniformTypeVec3:
-                            glUniform3f(uniform_location, gui_component.Data[0], gui_component.Data[1], gui_component.Data[2]);
-                            break;
-                        case EGUIUniformTypeVec4:
-                            glUniform4f(uniform_location, gui_component.Data[0], gui_component.Data[1], gui_component.Data[2], gui_component.Data[3]);
-                            break;
-                    }
-                }
-
-                for (const Texture& texture : render_pass.Textures) {
-                    glActiveTexture(GL_TEXTURE0 + texture_unit);
-                    glBindTexture(GL_TEXTURE_2D, texture.Id);
-                    glUniform1i(glGetUniformLocation(render_pass.Program.Handle, texture.Binding.c_str()), texture_unit);
-                    glUniform2f(glGetUniformLocation(render_pass.Program.Handle, (texture.Binding + "_resolution").c_str()), texture.Width, texture.Height);
-                    ++texture_unit;
-                }
+                BindPassUniforms(live_glsl, render_pass, program, width, height);
 
                 glBindVertexArray(live_glsl->VaoId);
 
-                for (auto& render_pass : live_glsl->RenderPasses) {
-                    if (render_pass.IsMain) {
-                        GLint position_attrib = glGetAttribLocation(render_pass.Program.Handle, "position");
-                        glVertexAttribPointer(position_attrib, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), 0);
-                        glEnableVertexAttribArray(position_attrib);
-                    }
-                }
+                GLint position_attrib = glGetAttribLocation(program, "position");
+                glVertexAttribPointer(position_attrib, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), 0);
+                glEnableVertexAttribArray(position_attrib);
 
                 glDrawArrays(GL_TRIANGLES, 0, 6);
+
+                ProfilerEndPass(live_glsl->Profiler);
+            }
+
+            ProfilerEndFrame(live_glsl->Profiler);
+
+            if (live_glsl->HeatmapView.Enabled) {
+                RequestHeatmapPrograms(live_glsl);
+                RenderHeatmap(live_glsl);
             }
 
             live_glsl->IsContinuousRendering = false;
             for (const auto& render_pass : live_glsl->RenderPasses) {
                 live_glsl->IsContinuousRendering |= glGetUniformLocation(render_pass.Program.Handle, "time") != -1;
             }
+            live_glsl->IsContinuousRendering &= FrameClockIsAdvancing(live_glsl->Clock);
 
             if (!live_glsl->Args.Output.empty()) {
                 uint32_t width = live_glsl->WindowWidth * live_glsl->PixelDensity;
@@ -341,11 +1028,7 @@ int LiveGLSLRender(LiveGLSL* live_glsl) {
 
         glfwSwapBuffers(live_glsl->GLFWWindowHandle);
 
-        if (live_glsl->IsContinuousRendering) {
-            glfwPollEvents();
-        } else {
-            glfwWaitEvents();
-        }
+        WaitForNextFrame(live_glsl, frame_start_time);
     }
 
     return EXIT_SUCCESS;
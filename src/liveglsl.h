@@ -4,17 +4,45 @@
 #include "arguments.h"
 #include "renderpass.h"
 #include "filewatcher.h"
+#include "frameclock.h"
+#include "glresource.h"
+#include "profiler.h"
+#include "heatmap.h"
+#include "shadercompiler.h"
+#include "variantcache.h"
+#include "playlist.h"
 
 #include <glad/gl.h>
 #include <atomic>
+#include <set>
 
 struct LiveGLSL {
     std::vector<GUIComponent> GUIComponents;
     std::vector<RenderPass> RenderPasses;
     GLFWwindow* GLFWWindowHandle;
     Arguments Args;
+    FrameClock Clock;
     HFileWatcher FileWatcher;
     HGUI GUI;
+    HProfiler Profiler;
+    HHeatmap Heatmap;
+    HShaderCompiler Compiler;
+    HVariantCache Variants;
+    std::set<uint64_t> PendingVariants;
+    std::set<uint64_t> UnavailableVariants;
+    // Keys of the instrumented variants submitted for the heatmap, owned by their pass
+    std::set<uint64_t> HeatmapVariants;
+    uint64_t FreezeValuesHash;
+    double FreezeValuesTime;
+    double FreezeSettleTime;
+    std::vector<PlaylistEntry> Playlist;
+    uint32_t PlaylistIndex;
+    int32_t PlaylistTarget;
+    int32_t PlaylistStep;
+    double PlaylistSwitchTime;
+    std::vector<std::string> Watches;
+    HeatmapSettings HeatmapView;
+    GLResourceStats ResourceBaseline;
     std::string ShaderPath;
     std::string BasePath;
     int WindowWidth;
@@ -25,6 +53,10 @@ struct LiveGLSL {
     std::atomic<bool> ShaderFileChanged;
     bool ShaderCompiled;
     bool IsContinuousRendering;
+    bool IsFocused;
+    bool IsIconified;
+    bool HasResourceBaseline;
+    bool IsFrozen;
 };
 
 LiveGLSL* LiveGLSLCreate(const Arguments& args);
@@ -6,6 +6,7 @@
 #endif
 
 #include "liveglsl.h"
+#include "validator.h"
 
 #if defined(_WIN32)
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
@@ -42,6 +43,10 @@ int main(int argc, const char **argv) {
         return EXIT_FAILURE;
     }
 
+    if (!args.ValidateDirectory.empty()) {
+        return ValidatorRun(args);
+    }
+
     LiveGLSL* live_glsl = LiveGLSLCreate(args);
     if (!live_glsl) {
         return EXIT_FAILURE;
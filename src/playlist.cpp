@@ -0,0 +1,67 @@
+#include "playlist.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+
+bool PlaylistLoad(const std::string& path, std::vector<PlaylistEntry>& entries, std::string& error) {
+    std::vector<std::string> paths;
+
+    std::error_code status_error;
+    if (!std::filesystem::exists(path, status_error)) {
+        error = "Playlist not found: " + path;
+        return false;
+    }
+
+    if (std::filesystem::is_directory(path, status_error)) {
+        paths = ListShaderFiles(path);
+    } else {
+        std::ifstream file(path);
+        std::string base_path = ExtractBasePath(path);
+        std::string line;
+
+        while (std::getline(file, line)) {
+            size_t first = line.find_first_not_of(" \t");
+            size_t last = line.find_last_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') {
+                continue;
+            }
+
+            line = line.substr(first, last - first + 1);
+            bool is_absolute = line[0] == '/' || line[0] == PATH_DELIMITER || (line.size() > 1 && line[1] == ':');
+            paths.push_back(is_absolute || base_path.empty() ? line : base_path + PATH_DELIMITER + line);
+        }
+    }
+
+    if (paths.empty()) {
+        error = "Playlist has no shader: " + path;
+        return false;
+    }
+
+    entries.clear();
+    for (const std::string& entry_path : paths) {
+        PlaylistEntry entry;
+        entry.Path = entry_path;
+        entries.push_back(entry);
+    }
+
+    return true;
+}
+
+uint32_t PlaylistNext(uint32_t index, int32_t step, uint32_t count) {
+    return (uint32_t)(((int64_t)index + step % (int64_t)count + count) % count);
+}
+
+std::vector<uint32_t> PlaylistNearEntries(uint32_t index, uint32_t count) {
+    // Going forward is the common case, the previous entry allows to go back once
+    std::vector<uint32_t> near;
+    for (int32_t step : {0, 1, -1, 2}) {
+        uint32_t near_index = PlaylistNext(index, step, count);
+        if (std::find(near.begin(), near.end(), near_index) == near.end()) {
+            near.push_back(near_index);
+        }
+    }
+    return near;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "shadercompiler.h"
+
+struct PlaylistEntry {
+    std::string Path;
+    // Render passes compiled ahead of time, or left behind when switching away
+    ShaderCompileResult Result;
+    int64_t LoadTime {0};
+    bool IsPending {false};
+    bool IsLoaded {false};
+};
+
+// Reads the shaders of a directory, or a text file listing one shader path per
+// line. Relative paths in a list are relative to the list itself.
+bool PlaylistLoad(const std::string& path, std::vector<PlaylistEntry>& entries, std::string& error);
+uint32_t PlaylistNext(uint32_t index, int32_t step, uint32_t count);
+// Entries kept loaded around an entry, the most likely to be shown next come first
+std::vector<uint32_t> PlaylistNearEntries(uint32_t index, uint32_t count);
@@ -0,0 +1,411 @@
+#include "preprocessor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <stdlib.h>
+
+struct PreprocessorValue {
+    int64_t Value;
+    bool IsKnown;
+};
+
+static const uint32_t MaxExpansionDepth = 16;
+
+static bool IsIdentifierChar(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+static std::string_view SkipSpaces(std::string_view text) {
+    while (!text.empty() && isspace((unsigned char)text.front())) {
+        text.remove_prefix(1);
+    }
+    return text;
+}
+
+std::string_view PreprocessorIdentifier(std::string_view& text) {
+    text = SkipSpaces(text);
+    size_t end = 0;
+    while (end < text.size() && IsIdentifierChar(text[end])) {
+        ++end;
+    }
+    std::string_view identifier = text.substr(0, end);
+    text.remove_prefix(end);
+    return identifier;
+}
+
+std::string_view PreprocessorDirective(std::string_view line, std::string_view& arguments) {
+    line = SkipSpaces(line);
+    if (line.empty() || line[0] != '#') {
+        return {};
+    }
+    line.remove_prefix(1);
+    std::string_view name = PreprocessorIdentifier(line);
+    arguments = line;
+    return name;
+}
+
+bool PreprocessorIsEmitting(const Preprocessor& preprocessor) {
+    if (preprocessor.Branches.empty()) {
+        return true;
+    }
+    const PreprocessorBranch& branch = preprocessor.Branches.back();
+    return branch.IsParentEmitting && (!branch.IsKnown || branch.IsActive);
+}
+
+static bool IsInUnknownBranch(const Preprocessor& preprocessor) {
+    for (const PreprocessorBranch& branch : preprocessor.Branches) {
+        if (!branch.IsKnown) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Whether a /* comment is still open at the end of the line
+static bool IsCommentOpen(std::string_view line, bool is_in_comment) {
+    for (size_t i = 0; i + 1 < line.size(); ++i) {
+        std::string_view token = line.substr(i, 2);
+        if (is_in_comment && token == "*/") {
+            is_in_comment = false;
+            ++i;
+        } else if (!is_in_comment && token == "//") {
+            return false;
+        } else if (!is_in_comment && token == "/*") {
+            is_in_comment = true;
+            ++i;
+        }
+    }
+    return is_in_comment;
+}
+
+// Comments are replaced by a space, an unterminated one runs to the end of the line
+static std::string StripComments(std::string_view text) {
+    std::string stripped;
+    while (!text.empty()) {
+        size_t start = std::min(text.find("//"), text.find("/*"));
+        stripped.append(text.substr(0, start));
+        if (start == std::string_view::npos || text.substr(start, 2) == "//") {
+            break;
+        }
+
+        size_t end = text.find("*/", start + 2);
+        stripped.push_back(' ');
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 2);
+    }
+    return stripped;
+}
+
+// Names reserved to the GLSL compiler depend on the driver and its extensions
+static bool IsReserved(std::string_view name) {
+    return name.substr(0, 3) == "GL_" || name.substr(0, 2) == "__";
+}
+
+// Recursive descent over the #if expression grammar. Anything it can not
+// decide, such as floating point values or undefined identifiers, is unknown.
+struct ExpressionParser {
+    const Preprocessor& State;
+    std::string_view Text;
+    uint32_t Depth;
+};
+
+static PreprocessorValue ParseExpression(ExpressionParser& parser, int precedence);
+
+static bool Consume(ExpressionParser& parser, std::string_view token) {
+    parser.Text = SkipSpaces(parser.Text);
+    if (parser.Text.substr(0, token.size()) != token) {
+        return false;
+    }
+    parser.Text.remove_prefix(token.size());
+    return true;
+}
+
+static PreprocessorValue Unknown() {
+    return {0, false};
+}
+
+static PreprocessorValue Known(int64_t value) {
+    return {value, true};
+}
+
+static PreprocessorValue ExpandMacro(ExpressionParser& parser, std::string_view name) {
+    auto it = parser.State.Macros.find(std::string(name));
+    if (it == parser.State.Macros.end() || !it->second.IsKnown || !it->second.IsDefined || it->second.IsFunction ||
+        parser.Depth >= MaxExpansionDepth) {
+        return Unknown();
+    }
+
+    ExpressionParser expansion = {parser.State, it->second.Value, parser.Depth + 1};
+    PreprocessorValue value = ParseExpression(expansion, 0);
+    return SkipSpaces(expansion.Text).empty() ? value : Unknown();
+}
+
+static PreprocessorValue ParsePrimary(ExpressionParser& parser) {
+    parser.Text = SkipSpaces(parser.Text);
+
+    if (Consume(parser, "(")) {
+        PreprocessorValue value = ParseExpression(parser, 0);
+        return Consume(parser, ")") ? value : Unknown();
+    }
+
+    if (Consume(parser, "!")) {
+        PreprocessorValue value = ParsePrimary(parser);
+        return {!value.Value, value.IsKnown};
+    }
+    if (Consume(parser, "~")) {
+        PreprocessorValue value = ParsePrimary(parser);
+        return {~value.Value, value.IsKnown};
+    }
+    if (Consume(parser, "-")) {
+        PreprocessorValue value = ParsePrimary(parser);
+        return {-value.Value, value.IsKnown};
+    }
+    if (Consume(parser, "+")) {
+        return ParsePrimary(parser);
+    }
+
+    if (!parser.Text.empty() && isdigit((unsigned char)parser.Text[0])) {
+        std::string number(parser.Text.substr(0, parser.Text.find_first_not_of("0123456789abcdefABCDEFxXuU")));
+        parser.Text.remove_prefix(number.size());
+        if (!number.empty() && (number.back() == 'u' || number.back() == 'U')) {
+            number.pop_back();
+        }
+
+        char* end = nullptr;
+        int64_t value = strtoll(number.c_str(), &end, 0);
+        bool is_integer = *end == '\0' && !Consume(parser, ".");
+        return is_integer ? Known(value) : Unknown();
+    }
+
+    std::string_view identifier = PreprocessorIdentifier(parser.Text);
+    if (identifier.empty()) {
+        return Unknown();
+    }
+
+    if (identifier == "defined") {
+        bool has_parenthesis = Consume(parser, "(");
+        std::string_view name = PreprocessorIdentifier(parser.Text);
+        if (name.empty() || (has_parenthesis && !Consume(parser, ")")) || IsReserved(name)) {
+            return Unknown();
+        }
+
+        auto it = parser.State.Macros.find(std::string(name));
+        if (it == parser.State.Macros.end()) {
+            return Known(0);
+        }
+        return it->second.IsKnown ? Known(it->second.IsDefined) : Unknown();
+    }
+
+    return ExpandMacro(parser, identifier);
+}
+
+struct BinaryOperator {
+    const char* Token;
+    int Precedence;
+};
+
+// Longer tokens first, so that "<=" is not read as "<"
+static const BinaryOperator BinaryOperators[] = {
+    {"||", 1}, {"&&", 2}, {"==", 6}, {"!=", 6}, {"<=", 7}, {">=", 7}, {"<<", 8}, {">>", 8},
+    {"|", 3}, {"^", 4}, {"&", 5}, {"<", 7}, {">", 7}, {"+", 9}, {"-", 9}, {"*", 10}, {"/", 10}, {"%", 10},
+};
+
+static PreprocessorValue Apply(const std::string& op, PreprocessorValue lhs, PreprocessorValue rhs) {
+    // A known operand can decide a logical operation on its own
+    if (op == "&&") {
+        if ((lhs.IsKnown && !lhs.Value) || (rhs.IsKnown && !rhs.Value)) {
+            return Known(0);
+        }
+        return lhs.IsKnown && rhs.IsKnown ? Known(1) : Unknown();
+    }
+    if (op == "||") {
+        if ((lhs.IsKnown && lhs.Value) || (rhs.IsKnown && rhs.Value)) {
+            return Known(1);
+        }
+        return lhs.IsKnown && rhs.IsKnown ? Known(0) : Unknown();
+    }
+
+    if (!lhs.IsKnown || !rhs.IsKnown) {
+        return Unknown();
+    }
+
+    int64_t a = lhs.Value;
+    int64_t b = rhs.Value;
+    if (op == "|") return Known(a | b);
+    if (op == "^") return Known(a ^ b);
+    if (op == "&") return Known(a & b);
+    if (op == "==") return Known(a == b);
+    if (op == "!=") return Known(a != b);
+    if (op == "<") return Known(a < b);
+    if (op == ">") return Known(a > b);
+    if (op == "<=") return Known(a <= b);
+    if (op == ">=") return Known(a >= b);
+    if (op == "<<") return b >= 0 && b < 63 ? Known(a << b) : Unknown();
+    if (op == ">>") return b >= 0 && b < 63 ? Known(a >> b) : Unknown();
+    if (op == "+") return Known(a + b);
+    if (op == "-") return Known(a - b);
+    if (op == "*") return Known(a * b);
+    if (op == "/") return b != 0 ? Known(a / b) : Unknown();
+    if (op == "%") return b != 0 ? Known(a % b) : Unknown();
+    return Unknown();
+}
+
+static PreprocessorValue ParseExpression(ExpressionParser& parser, int precedence) {
+    PreprocessorValue lhs = ParsePrimary(parser);
+
+    while (true) {
+        parser.Text = SkipSpaces(parser.Text);
+
+        const BinaryOperator* binary_operator = nullptr;
+        for (const BinaryOperator& candidate : BinaryOperators) {
+            if (parser.Text.substr(0, strlen(candidate.Token)) == candidate.Token) {
+                binary_operator = &candidate;
+                break;
+            }
+        }
+
+        if (!binary_operator || binary_operator->Precedence <= precedence) {
+            return lhs;
+        }
+
+        parser.Text.remove_prefix(strlen(binary_operator->Token));
+        PreprocessorValue rhs = ParseExpression(parser, binary_operator->Precedence);
+        lhs = Apply(binary_operator->Token, lhs, rhs);
+    }
+}
+
+static PreprocessorValue Evaluate(const Preprocessor& preprocessor, std::string_view directive, std::string_view arguments) {
+    if (directive == "if" || directive == "elif") {
+        // Comments are not part of the expression
+        std::string expression = StripComments(arguments);
+        ExpressionParser parser = {preprocessor, expression, 0};
+        PreprocessorValue value = ParseExpression(parser, 0);
+        return SkipSpaces(parser.Text).empty() ? value : Unknown();
+    }
+
+    std::string_view name = PreprocessorIdentifier(arguments);
+    if (name.empty() || IsReserved(name)) {
+        return Unknown();
+    }
+
+    auto it = preprocessor.Macros.find(std::string(name));
+    PreprocessorValue is_defined = it == preprocessor.Macros.end() ? Known(0) :
+        it->second.IsKnown ? Known(it->second.IsDefined) : Unknown();
+
+    if (directive == "ifndef") {
+        is_defined.Value = !is_defined.Value;
+    }
+    return is_defined;
+}
+
+static void Define(Preprocessor& preprocessor, std::string_view directive, std::string_view arguments) {
+    std::string_view name = PreprocessorIdentifier(arguments);
+    if (name.empty()) {
+        return;
+    }
+
+    PreprocessorMacro& macro = preprocessor.Macros[std::string(name)];
+    macro.IsDefined = directive == "define";
+    macro.IsKnown = !IsInUnknownBranch(preprocessor) && !preprocessor.IsNextDefineDynamic;
+    macro.IsFunction = macro.IsDefined && !arguments.empty() && arguments[0] == '(';
+
+    std::string value = StripComments(arguments);
+    macro.Value = std::string(SkipSpaces(value));
+
+    if (macro.IsDefined) {
+        preprocessor.IsNextDefineDynamic = false;
+    }
+}
+
+bool PreprocessorProcess(Preprocessor& preprocessor, std::string_view line, std::string& replacement) {
+    std::string_view arguments;
+    std::string_view directive = PreprocessorDirective(line, arguments);
+    bool is_emitting = PreprocessorIsEmitting(preprocessor);
+
+    replacement.clear();
+
+    bool is_in_comment = preprocessor.IsInComment;
+    preprocessor.IsInComment = IsCommentOpen(line, is_in_comment);
+    if (is_in_comment) {
+        return is_emitting;
+    }
+
+    if (directive.empty()) {
+        std::string_view text = SkipSpaces(line);
+        if (is_emitting && (text.substr(0, 7) == "@toggle" || text.substr(0, 7) == "@choice")) {
+            // The value of this define changes at runtime, its conditionals are left to the compiler
+            preprocessor.IsNextDefineDynamic = true;
+        } else if (text.substr(0, 9) == "@pass_end") {
+            // Each render pass is compiled on its own, definitions do not carry to the next one.
+            // Also set in an inactive branch, for the caller to report the open branches.
+            preprocessor.Macros.clear();
+            preprocessor.IsPassEnded = true;
+        }
+        return is_emitting;
+    }
+
+    if (directive == "if" || directive == "ifdef" || directive == "ifndef") {
+        PreprocessorBranch branch;
+        branch.IsParentEmitting = is_emitting;
+        if (is_emitting) {
+            PreprocessorValue value = Evaluate(preprocessor, directive, arguments);
+            branch.IsKnown = value.IsKnown;
+            branch.IsActive = !value.IsKnown || value.Value != 0;
+            branch.IsTaken = value.IsKnown && value.Value != 0;
+        }
+        preprocessor.Branches.push_back(branch);
+        return is_emitting && !branch.IsKnown;
+    }
+
+    bool is_branch_directive = directive == "elif" || directive == "else" || directive == "endif";
+    if (is_branch_directive && preprocessor.Branches.empty()) {
+        // Unbalanced, the compiler reports it
+        return is_emitting;
+    }
+
+    if (is_branch_directive) {
+        PreprocessorBranch& branch = preprocessor.Branches.back();
+        bool is_parent_emitting = branch.IsParentEmitting;
+        bool is_known = branch.IsKnown;
+
+        if (directive == "endif") {
+            preprocessor.Branches.pop_back();
+            return is_parent_emitting && !is_known;
+        }
+
+        if (!is_parent_emitting || !is_known) {
+            return is_parent_emitting;
+        }
+
+        if (directive == "else") {
+            branch.IsActive = !branch.IsTaken;
+            branch.IsTaken = true;
+            return false;
+        }
+
+        if (branch.IsTaken) {
+            branch.IsActive = false;
+            return false;
+        }
+
+        PreprocessorValue value = Evaluate(preprocessor, directive, arguments);
+        if (value.IsKnown) {
+            branch.IsActive = value.Value != 0;
+            branch.IsTaken = branch.IsActive;
+            return false;
+        }
+
+        // The previous branches were dropped, the compiler sees this one as the start of the conditional
+        branch.IsKnown = false;
+        branch.IsActive = true;
+        replacement = "#if" + std::string(arguments);
+        return true;
+    }
+
+    if (is_emitting && (directive == "define" || directive == "undef")) {
+        Define(preprocessor, directive, arguments);
+    }
+
+    return is_emitting;
+}
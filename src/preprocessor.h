@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+struct PreprocessorMacro {
+    std::string Value;
+    bool IsDefined {false};
+    // Whether the definition is the same whatever the branches taken so far,
+    // and whatever the values of GUI driven defines
+    bool IsKnown {true};
+    bool IsFunction {false};
+};
+
+struct PreprocessorBranch {
+    // Branches of a conditional whose value is known are resolved, their
+    // directives dropped along with the inactive branches. Other conditionals
+    // are kept as they are for the GLSL compiler.
+    bool IsKnown {true};
+    bool IsParentEmitting {true};
+    bool IsActive {false};
+    bool IsTaken {false};
+};
+
+struct Preprocessor {
+    std::unordered_map<std::string, PreprocessorMacro> Macros;
+    std::vector<PreprocessorBranch> Branches;
+    bool IsNextDefineDynamic {false};
+    // Whether a /* comment is left open by the last line, directives inside are
+    // ignored. Comments do not span files, the caller resets it for each one.
+    bool IsInComment {false};
+    // Set by @pass_end, for the caller to reset its own per pass state and to
+    // report the branches left open by the pass
+    bool IsPassEnded {false};
+};
+
+// Name of a preprocessor directive, the rest of the line is left in arguments
+std::string_view PreprocessorDirective(std::string_view line, std::string_view& arguments);
+std::string_view PreprocessorIdentifier(std::string_view& text);
+bool PreprocessorIsEmitting(const Preprocessor& preprocessor);
+// Follows a source line, returns false when it is dropped. A line that must be
+// emitted differently is returned in replacement.
+bool PreprocessorProcess(Preprocessor& preprocessor, std::string_view line, std::string& replacement);
@@ -0,0 +1,370 @@
+#include "profiler.h"
+
+#include "glextensions.h"
+#include "glresource.h"
+
+#include <fstream>
+#include <algorithm>
+#include <string.h>
+
+#define PROFILER_RING_SIZE 4
+#define PROFILER_HISTORY_SIZE 120
+
+struct ProfilerQuery {
+    std::string PassName;
+    uint64_t Pixels;
+    GLuint TimeElapsed;
+    GLuint SamplesPassed;
+    GLuint FragmentInvocations;
+};
+
+struct ProfilerFrame {
+    std::vector<ProfilerQuery> Queries;
+    uint32_t QueryCount;
+    bool IsPending;
+    bool HasStatistics;
+};
+
+struct ProfilerHistory {
+    float Samples[PROFILER_HISTORY_SIZE];
+    uint32_t SampleCount;
+    uint32_t NextSample;
+};
+
+struct ProfilerPassHistory {
+    std::string Name;
+    ProfilerHistory History;
+    uint64_t Pixels;
+    uint64_t SamplesPassed;
+    uint64_t FragmentInvocations;
+    bool HasStatistics;
+};
+
+struct Profiler {
+    ProfilerFrame Frames[PROFILER_RING_SIZE];
+    std::vector<ProfilerPassHistory> Passes;
+    ProfilerHistory FrameHistory;
+    uint32_t CurrentFrame;
+    bool IsRecording;
+    bool IsSupported;
+    bool HasFragmentInvocations;
+    bool RecordStatistics;
+};
+
+static void HistoryPush(ProfilerHistory& history, float sample) {
+    history.Samples[history.NextSample] = sample;
+    history.NextSample = (history.NextSample + 1) % PROFILER_HISTORY_SIZE;
+    history.SampleCount = std::min(history.SampleCount + 1, (uint32_t)PROFILER_HISTORY_SIZE);
+}
+
+static std::vector<float> HistorySamples(const ProfilerHistory& history) {
+    std::vector<float> samples;
+    uint32_t first = (history.NextSample + PROFILER_HISTORY_SIZE - history.SampleCount) % PROFILER_HISTORY_SIZE;
+    for (uint32_t i = 0; i < history.SampleCount; ++i) {
+        samples.push_back(history.Samples[(first + i) % PROFILER_HISTORY_SIZE]);
+    }
+    return samples;
+}
+
+static ProfilerPassTiming HistoryTiming(const std::string& name, const ProfilerHistory& history) {
+    ProfilerPassTiming timing;
+    timing.Name = name;
+    timing.Samples = history.SampleCount;
+
+    std::vector<float> samples = HistorySamples(history);
+    if (samples.empty()) {
+        return timing;
+    }
+
+    timing.LastMS = samples.back();
+    timing.MinMS = samples[0];
+    timing.MaxMS = samples[0];
+    double sum = 0.0;
+    for (float sample : samples) {
+        sum += sample;
+        timing.MinMS = std::min(timing.MinMS, (double)sample);
+        timing.MaxMS = std::max(timing.MaxMS, (double)sample);
+    }
+    timing.AverageMS = sum / samples.size();
+
+    return timing;
+}
+
+static ProfilerPassHistory& PassHistory(Profiler* profiler, const std::string& name) {
+    for (ProfilerPassHistory& pass : profiler->Passes) {
+        if (pass.Name == name) {
+            return pass;
+        }
+    }
+
+    ProfilerPassHistory pass;
+    pass.Name = name;
+    memset(&pass.History, 0x0, sizeof(pass.History));
+    pass.Pixels = 0;
+    pass.SamplesPassed = 0;
+    pass.FragmentInvocations = 0;
+    pass.HasStatistics = false;
+    profiler->Passes.push_back(pass);
+    return profiler->Passes.back();
+}
+
+static bool IsQueryAvailable(GLuint query) {
+    GLuint available = 0;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != 0;
+}
+
+static uint64_t QueryResult(GLuint query) {
+    GLuint64 result = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &result);
+    return result;
+}
+
+// Read back finished frames in submission order, stopping at the first one still in flight
+static void CollectFrames(Profiler* profiler) {
+    for (uint32_t i = 1; i <= PROFILER_RING_SIZE; ++i) {
+        ProfilerFrame& frame = profiler->Frames[(profiler->CurrentFrame + i) % PROFILER_RING_SIZE];
+        if (!frame.IsPending) {
+            continue;
+        }
+
+        const ProfilerQuery& last_query = frame.Queries[frame.QueryCount - 1];
+        bool is_available = IsQueryAvailable(last_query.TimeElapsed);
+        if (frame.HasStatistics) {
+            is_available &= IsQueryAvailable(last_query.SamplesPassed);
+            if (profiler->HasFragmentInvocations) {
+                is_available &= IsQueryAvailable(last_query.FragmentInvocations);
+            }
+        }
+        if (!is_available) {
+            return;
+        }
+
+        float frame_ms = 0.0f;
+        for (uint32_t i = 0; i < frame.QueryCount; ++i) {
+            const ProfilerQuery& query = frame.Queries[i];
+            ProfilerPassHistory& pass = PassHistory(profiler, query.PassName);
+
+            float elapsed_ms = QueryResult(query.TimeElapsed) / 1000000.0f;
+            HistoryPush(pass.History, elapsed_ms);
+            frame_ms += elapsed_ms;
+
+            pass.HasStatistics = frame.HasStatistics;
+            pass.Pixels = query.Pixels;
+            if (frame.HasStatistics) {
+                pass.SamplesPassed = QueryResult(query.SamplesPassed);
+                pass.FragmentInvocations = profiler->HasFragmentInvocations ? QueryResult(query.FragmentInvocations) : 0;
+            }
+        }
+
+        HistoryPush(profiler->FrameHistory, frame_ms);
+        frame.IsPending = false;
+    }
+}
+
+HProfiler ProfilerCreate() {
+    Profiler* profiler = new Profiler();
+    for (ProfilerFrame& frame : profiler->Frames) {
+        frame.QueryCount = 0;
+        frame.IsPending = false;
+    }
+    memset(&profiler->FrameHistory, 0x0, sizeof(profiler->FrameHistory));
+    profiler->CurrentFrame = 0;
+    profiler->IsRecording = false;
+    profiler->IsSupported = GLExtensionsGet().TimerQuery;
+    profiler->HasFragmentInvocations = GLExtensionsGet().PipelineStatisticsQuery;
+    profiler->RecordStatistics = false;
+    return profiler;
+}
+
+void ProfilerDestroy(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    for (ProfilerFrame& frame : profiler->Frames) {
+        for (ProfilerQuery& query : frame.Queries) {
+            GLResourceDestroy(EGLResourceTypeQuery, query.TimeElapsed);
+            GLResourceDestroy(EGLResourceTypeQuery, query.SamplesPassed);
+            GLResourceDestroy(EGLResourceTypeQuery, query.FragmentInvocations);
+        }
+    }
+    delete profiler;
+}
+
+void ProfilerReset(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    for (ProfilerFrame& frame : profiler->Frames) {
+        frame.IsPending = false;
+    }
+    profiler->Passes.clear();
+    memset(&profiler->FrameHistory, 0x0, sizeof(profiler->FrameHistory));
+}
+
+bool ProfilerIsSupported(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    return profiler->IsSupported;
+}
+
+bool ProfilerHasFragmentInvocations(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    return profiler->HasFragmentInvocations;
+}
+
+void ProfilerSetStatistics(HProfiler handle, bool enabled) {
+    Profiler* profiler = (Profiler*)handle;
+    profiler->RecordStatistics = enabled;
+}
+
+bool ProfilerGetStatistics(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    return profiler->RecordStatistics;
+}
+
+void ProfilerBeginFrame(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    if (!profiler->IsSupported) {
+        return;
+    }
+
+    profiler->CurrentFrame = (profiler->CurrentFrame + 1) % PROFILER_RING_SIZE;
+
+    // Skip the frame rather than waiting when the GPU is more than a ring behind
+    ProfilerFrame& frame = profiler->Frames[profiler->CurrentFrame];
+    profiler->IsRecording = !frame.IsPending;
+    if (profiler->IsRecording) {
+        frame.QueryCount = 0;
+        frame.HasStatistics = profiler->RecordStatistics;
+    }
+}
+
+void ProfilerBeginPass(HProfiler handle, const std::string& name, uint64_t pixels) {
+    Profiler* profiler = (Profiler*)handle;
+    if (!profiler->IsRecording) {
+        return;
+    }
+
+    ProfilerFrame& frame = profiler->Frames[profiler->CurrentFrame];
+    if (frame.QueryCount == frame.Queries.size()) {
+        ProfilerQuery query;
+        query.TimeElapsed = GLResourceCreate(EGLResourceTypeQuery);
+        query.SamplesPassed = 0;
+        query.FragmentInvocations = 0;
+        frame.Queries.push_back(query);
+    }
+
+    ProfilerQuery& query = frame.Queries[frame.QueryCount];
+    query.PassName = name;
+    query.Pixels = pixels;
+    glBeginQuery(GL_TIME_ELAPSED, query.TimeElapsed);
+
+    if (frame.HasStatistics) {
+        if (query.SamplesPassed == 0) {
+            query.SamplesPassed = GLResourceCreate(EGLResourceTypeQuery);
+        }
+        glBeginQuery(GL_SAMPLES_PASSED, query.SamplesPassed);
+
+        if (profiler->HasFragmentInvocations) {
+            if (query.FragmentInvocations == 0) {
+                query.FragmentInvocations = GLResourceCreate(EGLResourceTypeQuery);
+            }
+            glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB, query.FragmentInvocations);
+        }
+    }
+}
+
+void ProfilerEndPass(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    if (!profiler->IsRecording) {
+        return;
+    }
+
+    ProfilerFrame& frame = profiler->Frames[profiler->CurrentFrame];
+    glEndQuery(GL_TIME_ELAPSED);
+
+    if (frame.HasStatistics) {
+        glEndQuery(GL_SAMPLES_PASSED);
+        if (profiler->HasFragmentInvocations) {
+            glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS_ARB);
+        }
+    }
+
+    ++frame.QueryCount;
+}
+
+void ProfilerEndFrame(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    if (!profiler->IsSupported) {
+        return;
+    }
+
+    if (profiler->IsRecording) {
+        ProfilerFrame& frame = profiler->Frames[profiler->CurrentFrame];
+        frame.IsPending = frame.QueryCount > 0;
+        profiler->IsRecording = false;
+    }
+
+    CollectFrames(profiler);
+}
+
+std::vector<ProfilerPassTiming> ProfilerGetPassTimings(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    std::vector<ProfilerPassTiming> timings;
+    for (const ProfilerPassHistory& pass : profiler->Passes) {
+        ProfilerPassTiming timing = HistoryTiming(pass.Name, pass.History);
+        timing.Pixels = pass.Pixels;
+        timing.SamplesPassed = pass.SamplesPassed;
+        timing.FragmentInvocations = pass.FragmentInvocations;
+        timing.HasStatistics = pass.HasStatistics;
+        timings.push_back(timing);
+    }
+    return timings;
+}
+
+std::vector<float> ProfilerGetFrameTimes(HProfiler handle) {
+    Profiler* profiler = (Profiler*)handle;
+    return HistorySamples(profiler->FrameHistory);
+}
+
+bool ProfilerExport(HProfiler handle, const std::string& path) {
+    Profiler* profiler = (Profiler*)handle;
+    std::ofstream file(path);
+
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<ProfilerPassTiming> timings = ProfilerGetPassTimings(handle);
+    timings.push_back(HistoryTiming("frame", profiler->FrameHistory));
+
+    bool is_json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    if (is_json) {
+        file << "{\n  \"passes\": [\n";
+        for (size_t i = 0; i < timings.size(); ++i) {
+            const ProfilerPassTiming& timing = timings[i];
+            file << "    {\"name\": \"" << timing.Name << "\", \"samples\": " << timing.Samples;
+            file << ", \"average_ms\": " << timing.AverageMS;
+            file << ", \"min_ms\": " << timing.MinMS;
+            file << ", \"max_ms\": " << timing.MaxMS;
+            if (timing.HasStatistics) {
+                file << ", \"pixels\": " << timing.Pixels;
+                file << ", \"samples_passed\": " << timing.SamplesPassed;
+                file << ", \"fragment_invocations\": " << timing.FragmentInvocations;
+            }
+            file << "}";
+            file << (i + 1 < timings.size() ? ",\n" : "\n");
+        }
+        file << "  ],\n  \"frame_times_ms\": [";
+        std::vector<float> frame_times = ProfilerGetFrameTimes(handle);
+        for (size_t i = 0; i < frame_times.size(); ++i) {
+            file << (i > 0 ? ", " : "") << frame_times[i];
+        }
+        file << "]\n}\n";
+    } else {
+        file << "pass,samples,average_ms,min_ms,max_ms,pixels,samples_passed,fragment_invocations" << std::endl;
+        for (const ProfilerPassTiming& timing : timings) {
+            file << timing.Name << "," << timing.Samples << "," << timing.AverageMS << "," << timing.MinMS << "," << timing.MaxMS << ",";
+            file << timing.Pixels << "," << timing.SamplesPassed << "," << timing.FragmentInvocations << std::endl;
+        }
+    }
+
+    file.close();
+    return true;
+}
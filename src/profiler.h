@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+struct ProfilerPassTiming {
+    std::string Name;
+    uint32_t Samples {0};
+    double LastMS {0.0};
+    double AverageMS {0.0};
+    double MinMS {0.0};
+    double MaxMS {0.0};
+    uint64_t Pixels {0};
+    uint64_t SamplesPassed {0};
+    uint64_t FragmentInvocations {0};
+    bool HasStatistics {false};
+};
+
+typedef void* HProfiler;
+
+// GPU timings are measured with GL_TIME_ELAPSED queries taken from a small ring
+// of frames, and read back once available so that the pipeline never stalls.
+// When enabled, samples passed and fragment shader invocations are counted
+// the same way.
+HProfiler ProfilerCreate();
+void ProfilerDestroy(HProfiler profiler);
+void ProfilerReset(HProfiler profiler);
+bool ProfilerIsSupported(HProfiler profiler);
+bool ProfilerHasFragmentInvocations(HProfiler profiler);
+void ProfilerSetStatistics(HProfiler profiler, bool enabled);
+bool ProfilerGetStatistics(HProfiler profiler);
+void ProfilerBeginFrame(HProfiler profiler);
+void ProfilerBeginPass(HProfiler profiler, const std::string& name, uint64_t pixels);
+void ProfilerEndPass(HProfiler profiler);
+void ProfilerEndFrame(HProfiler profiler);
+std::vector<ProfilerPassTiming> ProfilerGetPassTimings(HProfiler profiler);
+std::vector<float> ProfilerGetFrameTimes(HProfiler profiler);
+bool ProfilerExport(HProfiler profiler, const std::string& path);
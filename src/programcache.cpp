@@ -0,0 +1,178 @@
+#include "programcache.h"
+
+#include "glextensions.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+#include <vector>
+
+static const char ProgramCacheMagic[4] = {'L', 'G', 'P', 'B'};
+static const uint32_t ProgramCacheVersion = 1;
+
+struct ProgramCacheHeader {
+    char Magic[4];
+    uint32_t Version;
+    uint64_t Key;
+    uint32_t Format;
+    uint32_t Length;
+};
+
+struct ProgramCache {
+    std::mutex Mutex;
+    std::string Directory;
+    std::string DriverString;
+};
+
+static ProgramCache& GetProgramCache() {
+    static ProgramCache cache;
+    return cache;
+}
+
+static std::string ProgramCachePath(const std::string& directory, uint64_t key) {
+    char filename[32];
+    snprintf(filename, sizeof(filename), "%016llx.bin", (unsigned long long)key);
+    return directory + PATH_DELIMITER + filename;
+}
+
+void ProgramCacheSetDirectory(const std::string& directory) {
+    ProgramCache& cache = GetProgramCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+
+    cache.Directory.clear();
+    if (!directory.empty() && !CreateDirectories(directory)) {
+        fprintf(stderr, "Failed to create program cache directory: %s\n", directory.c_str());
+        return;
+    }
+    cache.Directory = directory;
+}
+
+bool ProgramCacheIsEnabled() {
+    ProgramCache& cache = GetProgramCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    return !cache.Directory.empty() && GLExtensionsGet().ProgramBinary;
+}
+
+uint64_t ProgramCacheKey(const std::string& vertex_source, const std::string& fragment_source) {
+    ProgramCache& cache = GetProgramCache();
+    std::string driver_string;
+    {
+        std::lock_guard<std::mutex> lock(cache.Mutex);
+        if (cache.DriverString.empty()) {
+            // Binaries are only valid for the exact driver that produced them
+            const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION};
+            for (GLenum name : names) {
+                const char* value = (const char*)glGetString(name);
+                cache.DriverString += value ? value : "";
+                cache.DriverString += '\n';
+            }
+        }
+        driver_string = cache.DriverString;
+    }
+
+    uint64_t key = HashFNV1aBytes(&ProgramCacheVersion, sizeof(ProgramCacheVersion));
+    key = HashFNV1a(driver_string, key);
+    key = HashFNV1a(vertex_source, key);
+    // Separate both stages so that moving text from one to the other changes the key
+    key = HashFNV1aBytes("\0", 1, key);
+    key = HashFNV1a(fragment_source, key);
+    return key;
+}
+
+bool ProgramCacheLoad(GLuint program, uint64_t key) {
+    std::string directory;
+    {
+        ProgramCache& cache = GetProgramCache();
+        std::lock_guard<std::mutex> lock(cache.Mutex);
+        directory = cache.Directory;
+    }
+
+    FILE* file = fopen(ProgramCachePath(directory, key).c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    // A truncated or corrupted file is a miss, its length is never trusted for the allocation
+    long file_size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    rewind(file);
+
+    ProgramCacheHeader header;
+    std::vector<char> binary;
+    bool is_valid = file_size >= (long)sizeof(header) &&
+        fread(&header, sizeof(header), 1, file) == 1 &&
+        memcmp(header.Magic, ProgramCacheMagic, sizeof(header.Magic)) == 0 &&
+        header.Version == ProgramCacheVersion &&
+        header.Key == key &&
+        header.Length > 0 &&
+        header.Length == (uint64_t)(file_size - (long)sizeof(header));
+
+    if (is_valid) {
+        binary.resize(header.Length);
+        is_valid = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+
+    fclose(file);
+
+    if (!is_valid) {
+        return false;
+    }
+
+    glProgramBinary(program, header.Format, binary.data(), (GLsizei)binary.size());
+
+    // A driver update can reject a binary even with matching strings, the caller then compiles from source
+    GLint is_linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
+    return is_linked == GL_TRUE;
+}
+
+void ProgramCacheStore(GLuint program, uint64_t key) {
+    std::string directory;
+    {
+        ProgramCache& cache = GetProgramCache();
+        std::lock_guard<std::mutex> lock(cache.Mutex);
+        directory = cache.Directory;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    ProgramCacheHeader header;
+    memcpy(header.Magic, ProgramCacheMagic, sizeof(header.Magic));
+    header.Version = ProgramCacheVersion;
+    header.Key = key;
+
+    std::vector<char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return;
+    }
+    header.Format = format;
+    header.Length = written;
+
+    // Write to a temporary file first so that a concurrent reader never sees a partial binary
+    std::string path = ProgramCachePath(directory, key);
+    std::string temporary_path = TemporaryFilePath(path);
+    FILE* file = fopen(temporary_path.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+
+    bool is_written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(binary.data(), 1, written, file) == (size_t)written;
+    fclose(file);
+
+    if (!is_written) {
+        remove(temporary_path.c_str());
+        return;
+    }
+
+    if (!RenameFile(temporary_path, path)) {
+        remove(temporary_path.c_str());
+    }
+}
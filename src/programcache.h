@@ -0,0 +1,14 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <string>
+#include <stdint.h>
+
+// Linked programs are stored in a cache directory as driver binaries, keyed by
+// a hash of their full sources and of the driver identification strings. Any
+// mismatch when restoring a binary falls back to compiling from source.
+void ProgramCacheSetDirectory(const std::string& directory);
+bool ProgramCacheIsEnabled();
+uint64_t ProgramCacheKey(const std::string& vertex_source, const std::string& fragment_source);
+bool ProgramCacheLoad(GLuint program, uint64_t key);
+void ProgramCacheStore(GLuint program, uint64_t key);
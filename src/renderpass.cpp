@@ -1,7 +1,11 @@
 #include "renderpass.h"
 
+#include "glresource.h"
+#include "utils.h"
+
 #include <assert.h>
-#include <stb/stb_image.h>
+#include <stdio.h>
+#include <set>
 
 static const GLchar* DefaultVertexShader = R"END(
 in vec2 position;
@@ -12,76 +16,245 @@ void main() {
 
 void RenderPassDestroy(std::vector<RenderPass>& render_passes) {
     for (auto& render_pass : render_passes) {
-        ShaderProgramDetach(render_pass.Program);
+        ShaderProgramDestroy(render_pass.Program);
+        ShaderProgramDestroy(render_pass.HeatmapProgram);
 
-        if (render_pass.TextureId != 0) {
-            glDeleteTextures(1, &render_pass.TextureId);
+        GLResourceDestroy(EGLResourceTypeTexture, render_pass.TextureId);
+        GLResourceDestroy(EGLResourceTypeFramebuffer, render_pass.FBO);
+    }
+
+    render_passes.clear();
+}
+
+uint64_t RenderPassHash(const RenderPass& render_pass) {
+    uint64_t hash = HashFNV1a(render_pass.ShaderSource);
+    hash = HashFNV1a(render_pass.Input, hash);
+    hash = HashFNV1a("\n" + render_pass.Output, hash);
+    hash = HashFNV1aBytes(&render_pass.Width, sizeof(render_pass.Width), hash);
+    hash = HashFNV1aBytes(&render_pass.Height, sizeof(render_pass.Height), hash);
+    hash = HashFNV1aBytes(&render_pass.IsMain, sizeof(render_pass.IsMain), hash);
+    return hash;
+}
+
+void RenderPassReuse(std::vector<RenderPass>& render_passes, const std::vector<RenderPass>& previous_passes) {
+    std::vector<bool> is_claimed(previous_passes.size(), false);
+
+    for (auto& render_pass : render_passes) {
+        render_pass.Hash = RenderPassHash(render_pass);
+
+        for (size_t i = 0; i < previous_passes.size(); ++i) {
+            const RenderPass& previous = previous_passes[i];
+            if (is_claimed[i] || previous.Hash != render_pass.Hash || previous.Program.Handle == 0) {
+                continue;
+            }
+
+            render_pass.Program = previous.Program;
+            render_pass.IsProgramReused = true;
+
+            render_pass.TextureId = previous.TextureId;
+            render_pass.FBO = previous.FBO;
+            render_pass.IsTargetReused = render_pass.TextureId != 0;
+
+            is_claimed[i] = true;
+            break;
+        }
+    }
+}
+
+void RenderPassReleaseReused(std::vector<RenderPass>& render_passes) {
+    // Reused objects are still owned by the previous passes
+    for (auto& render_pass : render_passes) {
+        if (render_pass.IsProgramReused) {
+            render_pass.Program = ShaderProgram();
+            render_pass.IsProgramReused = false;
+        }
+
+        if (render_pass.IsTargetReused) {
+            render_pass.TextureId = 0;
+            render_pass.FBO = 0;
+            render_pass.IsTargetReused = false;
+        }
+    }
+}
+
+void RenderPassDestroyReplaced(std::vector<RenderPass>& previous_passes, std::vector<RenderPass>& render_passes) {
+    for (auto& previous : previous_passes) {
+        for (auto& render_pass : render_passes) {
+            if (render_pass.IsProgramReused && render_pass.Program.Handle == previous.Program.Handle) {
+                // The heatmap program is compiled once the pass is live and belongs to the pass holding it,
+                // so it moves along with a reused program
+                render_pass.HeatmapProgram = previous.HeatmapProgram;
+                render_pass.HeatmapError = previous.HeatmapError;
+                previous.Program = ShaderProgram();
+                previous.HeatmapProgram = ShaderProgram();
+            }
+
+            if (render_pass.IsTargetReused && render_pass.TextureId == previous.TextureId) {
+                previous.TextureId = 0;
+                previous.FBO = 0;
+            }
+        }
+    }
+
+    RenderPassDestroy(previous_passes);
+}
+
+GLResourceStats RenderPassResourceStats(const std::vector<RenderPass>& render_passes) {
+    GLResourceStats stats;
+
+    for (const auto& render_pass : render_passes) {
+        if (render_pass.Program.Handle != 0) {
+            ++stats.Count[EGLResourceTypeProgram];
+        }
+
+        if (render_pass.HeatmapProgram.Handle != 0) {
+            ++stats.Count[EGLResourceTypeProgram];
         }
 
         if (render_pass.FBO != 0) {
-            glDeleteFramebuffers(1, &render_pass.FBO);
+            ++stats.Count[EGLResourceTypeFramebuffer];
+        }
+
+        if (render_pass.TextureId != 0) {
+            ++stats.Count[EGLResourceTypeTexture];
+            stats.Bytes[EGLResourceTypeTexture] += GLResourceTextureBytes(render_pass.Width, render_pass.Height, GL_RGBA8);
+        }
+    }
+
+    return stats;
+}
+
+std::string RenderPassName(const RenderPass& render_pass) {
+    return render_pass.Output.empty() ? "main" : render_pass.Output;
+}
+
+int64_t RenderPassRequiredBytes(const std::vector<RenderPass>& render_passes) {
+    int64_t bytes = 0;
+    std::set<const TextureImage*> images;
+
+    for (const auto& render_pass : render_passes) {
+        if (!render_pass.IsMain) {
+            bytes += GLResourceTextureBytes(render_pass.Width, render_pass.Height, GL_RGBA8);
         }
 
-        for (auto& texture : render_pass.Textures) {
-            if (texture.Id != 0) {
-                glDeleteTextures(1, &texture.Id);
-                stbi_image_free(texture.Data);
+        // Images already uploaded are part of the memory in use
+        for (const auto& texture : render_pass.Textures) {
+            if (images.insert(texture.Image.get()).second && TextureCacheGetId(*texture.Image) == 0) {
+                bytes += GLResourceTextureBytes(texture.Width, texture.Height, texture.Image->InternalFormat);
             }
         }
     }
 
-    render_passes.clear();
+    return bytes;
 }
 
-bool RenderPassCreate(std::vector<RenderPass>& render_passes, std::string& error) {
-    for (auto& render_pass : render_passes) {
-        if (!ShaderProgramCreate(render_pass.Program, render_pass.ShaderSource, DefaultVertexShader, error)) {
+bool RenderPassCheckLimits(const std::vector<RenderPass>& render_passes, int64_t budget_bytes, int64_t reserved_bytes, std::string& error) {
+    GLint max_texture_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+
+    auto exceeds_max_size = [&](const std::string& name, int width, int height) {
+        if (width <= max_texture_size && height <= max_texture_size) {
             return false;
         }
+        error = name + " size " + std::to_string(width) + "x" + std::to_string(height) +
+            " exceeds GL_MAX_TEXTURE_SIZE (" + std::to_string(max_texture_size) + ")";
+        return true;
+    };
 
-        if (!render_pass.IsMain) {
-            glGenFramebuffers(1, &render_pass.FBO);
-            glBindFramebuffer(GL_FRAMEBUFFER, render_pass.FBO);
+    for (const auto& render_pass : render_passes) {
+        if (!render_pass.IsMain && exceeds_max_size("Render pass " + RenderPassName(render_pass), render_pass.Width, render_pass.Height)) {
+            return false;
+        }
+
+        for (const auto& texture : render_pass.Textures) {
+            if (exceeds_max_size("Texture " + texture.Path, texture.Width, texture.Height)) {
+                return false;
+            }
+        }
+    }
+
+    int64_t required_bytes = RenderPassRequiredBytes(render_passes);
+    if (budget_bytes > 0 && reserved_bytes + required_bytes > budget_bytes) {
+        char message[256];
+        snprintf(message, sizeof(message), "Render passes require %.2f MB, only %.2f MB left in the %.2f MB GPU memory budget",
+            required_bytes / (1024.0 * 1024.0),
+            (budget_bytes - reserved_bytes) / (1024.0 * 1024.0),
+            budget_bytes / (1024.0 * 1024.0));
+        error = message;
+        return false;
+    }
 
-            glGenTextures(1, &render_pass.TextureId);
+    return true;
+}
+
+bool RenderPassCreateShared(std::vector<RenderPass>& render_passes, std::string& error) {
+    // Every program is submitted before any status is read, uploads overlap with compilation
+    for (auto& render_pass : render_passes) {
+        if (!render_pass.IsProgramReused) {
+            ShaderProgramBegin(render_pass.Program, render_pass.ShaderSource, DefaultVertexShader);
+        }
+    }
+
+    for (auto& render_pass : render_passes) {
+        if (!render_pass.IsMain && !render_pass.IsTargetReused) {
+            render_pass.TextureId = GLResourceCreate(EGLResourceTypeTexture);
             glBindTexture(GL_TEXTURE_2D, render_pass.TextureId);
 
             assert(render_pass.Width != 0);
             assert(render_pass.Height != 0);
 
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, render_pass.Width, render_pass.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, render_pass.Width, render_pass.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            GLResourceDescribe(EGLResourceTypeTexture, render_pass.TextureId, GLResourceTextureInfo(RenderPassName(render_pass), "target", render_pass.Width, render_pass.Height, GL_RGBA8));
 
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, render_pass.TextureId, 0);
-
-            assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
-
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
             glBindTexture(GL_TEXTURE_2D, 0);
         }
 
         for (Texture& texture : render_pass.Textures) {
-            glGenTextures(1, &texture.Id);
-            glBindTexture(GL_TEXTURE_2D, texture.Id);
-
-            assert(texture.Width != 0);
-            assert(texture.Height != 0);
-            assert(texture.Data);
+            assert(texture.Image);
+            TextureCacheUpload(*texture.Image);
+        }
+    }
 
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture.Width, texture.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texture.Data);
+    for (auto& render_pass : render_passes) {
+        if (!render_pass.IsProgramReused && !ShaderProgramEnd(render_pass.Program, error)) {
+            return false;
+        }
+    }
 
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return true;
+}
 
-            glBindTexture(GL_TEXTURE_2D, 0);
+void RenderPassCreateFramebuffers(std::vector<RenderPass>& render_passes) {
+    for (auto& render_pass : render_passes) {
+        if (render_pass.IsMain || render_pass.FBO != 0) {
+            continue;
         }
+
+        render_pass.FBO = GLResourceCreate(EGLResourceTypeFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, render_pass.FBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, render_pass.TextureId, 0);
+
+        assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+}
+
+bool RenderPassCreate(std::vector<RenderPass>& render_passes, std::string& error) {
+    if (!RenderPassCreateShared(render_passes, error)) {
+        return false;
     }
 
+    RenderPassCreateFramebuffers(render_passes);
+
     return true;
-}
\ No newline at end of file
+}
+
+void RenderPassBeginVariant(ShaderProgram& program, const std::string& fragment_source) {
+    ShaderProgramBegin(program, fragment_source, DefaultVertexShader);
+}
@@ -2,23 +2,30 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 
 #include <glad/gl.h>
 
 #include "shader.h"
+#include "glresource.h"
+#include "texturecache.h"
 
 struct Texture {
     int Width;
     int Height;
     int Channels;
-    unsigned char* Data {nullptr};
+    std::shared_ptr<TextureImage> Image;
     std::string Binding;
-    GLuint Id {0};
+    std::string Path;
 };
 
 struct RenderPass {
     ShaderProgram Program;
+    ShaderProgram HeatmapProgram;
+    std::string HeatmapError;
     std::vector<Texture> Textures;
+    // Names of the #define switches driven by GUI components in this pass
+    std::vector<std::string> Defines;
     std::string ShaderSource;
     std::string Input;
     std::string Output;
@@ -27,7 +34,28 @@ struct RenderPass {
     uint32_t Height {0};
     GLuint FBO {0};
     GLuint TextureId {0};
+    uint64_t Hash {0};
+    // Key of the last define variant drawn, it keeps being drawn while the next selection compiles
+    uint64_t DefineVariantKey {0};
+    bool IsProgramReused {false};
+    bool IsTargetReused {false};
 };
 
+std::string RenderPassName(const RenderPass& render_pass);
+uint64_t RenderPassHash(const RenderPass& render_pass);
 void RenderPassDestroy(std::vector<RenderPass>& render_passes);
-bool RenderPassCreate(std::vector<RenderPass>& render_passes, std::string& error);
\ No newline at end of file
+// Passes whose hash matches a previous pass take over its program and target instead of creating them
+void RenderPassReuse(std::vector<RenderPass>& render_passes, const std::vector<RenderPass>& previous_passes);
+void RenderPassReleaseReused(std::vector<RenderPass>& render_passes);
+void RenderPassDestroyReplaced(std::vector<RenderPass>& previous_passes, std::vector<RenderPass>& render_passes);
+// Textures loaded from files are owned by the texture cache, they are not counted
+GLResourceStats RenderPassResourceStats(const std::vector<RenderPass>& render_passes);
+int64_t RenderPassRequiredBytes(const std::vector<RenderPass>& render_passes);
+bool RenderPassCheckLimits(const std::vector<RenderPass>& render_passes, int64_t budget_bytes, int64_t reserved_bytes, std::string& error);
+bool RenderPassCreate(std::vector<RenderPass>& render_passes, std::string& error);
+// Programs and textures are shared between contexts, framebuffers are not: they
+// must be created on the context that renders the passes.
+bool RenderPassCreateShared(std::vector<RenderPass>& render_passes, std::string& error);
+void RenderPassCreateFramebuffers(std::vector<RenderPass>& render_passes);
+// Begins a program made of the pass vertex shader and a variant of its fragment source
+void RenderPassBeginVariant(ShaderProgram& program, const std::string& fragment_source);
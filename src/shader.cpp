@@ -1,26 +1,17 @@
 #include  "shader.h"
 
-void ShaderProgramDestroy(ShaderProgram& shader_program) {
-    if (shader_program.Handle) {
-        glDeleteProgram(shader_program.Handle);
-    }
-
-    if (shader_program.VertexShaderHandle) {
-        glDeleteShader(shader_program.VertexShaderHandle);
-    }
+#include "glresource.h"
+#include "glextensions.h"
+#include "programcache.h"
 
-    if (shader_program.FragmentShaderHandle) {
-        glDeleteShader(shader_program.FragmentShaderHandle);
-    }
+void ShaderProgramDestroy(ShaderProgram& shader_program) {
+    GLResourceDestroy(EGLResourceTypeProgram, shader_program.Handle);
+    GLResourceDestroy(EGLResourceTypeShader, shader_program.VertexShaderHandle);
+    GLResourceDestroy(EGLResourceTypeShader, shader_program.FragmentShaderHandle);
 }
 
-GLuint ShaderProgramCompile(const std::string src, GLenum type, std::string& error) {
+static bool ShaderCompileStatus(GLuint shader, std::string& error) {
     GLint compile_status;
-    GLuint shader = glCreateShader(type);
-    const GLchar* source = (const GLchar*) src.c_str();
-
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
     glGetShaderiv(shader, GL_COMPILE_STATUS, &compile_status);
 
     if (!compile_status) {
@@ -28,37 +19,88 @@ GLuint ShaderProgramCompile(const std::string src, GLenum type, std::string& err
         glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
         
         char info[8096];
-        glGetShaderInfoLog(shader, length, NULL, info);
+        glGetShaderInfoLog(shader, sizeof(info), NULL, info);
         
         error = info;
+        return false;
+    }
+
+    return true;
+}
+
+static GLuint ShaderSubmit(const std::string& src, GLenum type) {
+    GLuint shader = GLResourceCreate(EGLResourceTypeShader, type);
+    const GLchar* source = (const GLchar*) src.c_str();
+
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    return shader;
+}
 
-        glDeleteShader(shader);
+GLuint ShaderProgramCompile(const std::string src, GLenum type, std::string& error) {
+    GLuint shader = ShaderSubmit(src, type);
+
+    if (!ShaderCompileStatus(shader, error)) {
+        GLResourceDestroy(EGLResourceTypeShader, shader);
         return 0;
     }
 
     return shader;
 }
 
-bool ShaderProgramCreate(ShaderProgram& shader_program, const std::string& fragment_source, const std::string& vertex_source, std::string& error) {
+void ShaderProgramBegin(ShaderProgram& shader_program, const std::string& fragment_source, const std::string& vertex_source) {
     std::string shader_prelude = "#version 150\n";
+    std::string full_vertex_source = shader_prelude + vertex_source;
+    std::string full_fragment_source = shader_prelude + fragment_source;
 
-    shader_program.VertexShaderHandle = ShaderProgramCompile(shader_prelude + vertex_source, GL_VERTEX_SHADER, error);
-    shader_program.FragmentShaderHandle = ShaderProgramCompile(shader_prelude + fragment_source, GL_FRAGMENT_SHADER, error);
+    shader_program.CacheKey = 0;
 
-    if (!shader_program.FragmentShaderHandle || !shader_program.VertexShaderHandle) {
-        ShaderProgramDestroy(shader_program);
-        return false;
+    if (ProgramCacheIsEnabled()) {
+        uint64_t cache_key = ProgramCacheKey(full_vertex_source, full_fragment_source);
+        shader_program.Handle = GLResourceCreate(EGLResourceTypeProgram);
+
+        if (ProgramCacheLoad(shader_program.Handle, cache_key)) {
+            return;
+        }
+
+        GLResourceDestroy(EGLResourceTypeProgram, shader_program.Handle);
+        shader_program.CacheKey = cache_key;
     }
 
-    shader_program.Handle = glCreateProgram();
+    // Status is only queried in ShaderProgramEnd, so that the driver can work on several programs at once
+    shader_program.VertexShaderHandle = ShaderSubmit(full_vertex_source, GL_VERTEX_SHADER);
+    shader_program.FragmentShaderHandle = ShaderSubmit(full_fragment_source, GL_FRAGMENT_SHADER);
+
+    shader_program.Handle = GLResourceCreate(EGLResourceTypeProgram);
 
     glAttachShader(shader_program.Handle, shader_program.VertexShaderHandle);
     glAttachShader(shader_program.Handle, shader_program.FragmentShaderHandle);
 
+    if (shader_program.CacheKey != 0) {
+        glProgramParameteri(shader_program.Handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     glLinkProgram(shader_program.Handle);
+}
+
+bool ShaderProgramEnd(ShaderProgram& shader_program, std::string& error) {
+    if (shader_program.VertexShaderHandle == 0 && shader_program.FragmentShaderHandle == 0) {
+        // Restored from the program cache, already linked
+        return shader_program.Handle != 0;
+    }
+
+    if (!ShaderCompileStatus(shader_program.VertexShaderHandle, error) ||
+        !ShaderCompileStatus(shader_program.FragmentShaderHandle, error)) {
+        ShaderProgramDestroy(shader_program);
+        return false;
+    }
 
-    glDeleteShader(shader_program.FragmentShaderHandle);
-    glDeleteShader(shader_program.VertexShaderHandle);
+    // The linked program does not need the shader objects anymore
+    glDetachShader(shader_program.Handle, shader_program.FragmentShaderHandle);
+    glDetachShader(shader_program.Handle, shader_program.VertexShaderHandle);
+    GLResourceDestroy(EGLResourceTypeShader, shader_program.FragmentShaderHandle);
+    GLResourceDestroy(EGLResourceTypeShader, shader_program.VertexShaderHandle);
 
     GLint is_linked;
     glGetProgramiv(shader_program.Handle, GL_LINK_STATUS, &is_linked);
@@ -69,15 +111,14 @@ bool ShaderProgramCreate(ShaderProgram& shader_program, const std::string& fragm
         return false;
     }
 
+    if (shader_program.CacheKey != 0) {
+        ProgramCacheStore(shader_program.Handle, shader_program.CacheKey);
+    }
+
     return true;
 }
 
-void ShaderProgramDetach(const ShaderProgram& shader_program) {
-    if (shader_program.VertexShaderHandle) {
-        glDetachShader(shader_program.VertexShaderHandle, GL_VERTEX_SHADER);
-    }
-
-    if (shader_program.FragmentShaderHandle) {
-        glDetachShader(shader_program.FragmentShaderHandle, GL_FRAGMENT_SHADER);
-    }
-}
\ No newline at end of file
+bool ShaderProgramCreate(ShaderProgram& shader_program, const std::string& fragment_source, const std::string& vertex_source, std::string& error) {
+    ShaderProgramBegin(shader_program, fragment_source, vertex_source);
+    return ShaderProgramEnd(shader_program, error);
+}
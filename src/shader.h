@@ -3,11 +3,13 @@
 #include <glad/gl.h>
 #include <string.h>
 #include <string>
+#include <stdint.h>
 
 struct ShaderProgram {
     GLuint Handle;
     GLuint FragmentShaderHandle;
     GLuint VertexShaderHandle;
+    uint64_t CacheKey;
 
     ShaderProgram() {
         memset(this, 0x0, sizeof(ShaderProgram));
@@ -17,4 +19,8 @@ struct ShaderProgram {
 void ShaderProgramDestroy(ShaderProgram& shader_program);
 GLuint ShaderProgramCompile(const std::string src, GLenum type, std::string& error);
 bool ShaderProgramCreate(ShaderProgram& shader_program, const std::string& fragment_source, const std::string& vertex_source, std::string& error);
-void ShaderProgramDetach(const ShaderProgram& shader_program);
\ No newline at end of file
+// Issues compilation and linking without waiting on the driver, ShaderProgramEnd
+// then collects the status. Beginning several programs before ending any lets
+// drivers compile them in parallel.
+void ShaderProgramBegin(ShaderProgram& shader_program, const std::string& fragment_source, const std::string& vertex_source);
+bool ShaderProgramEnd(ShaderProgram& shader_program, std::string& error);
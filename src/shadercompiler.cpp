@@ -0,0 +1,345 @@
+#include "shadercompiler.h"
+
+#include "shaderparser.h"
+#include "glresource.h"
+#include "glextensions.h"
+
+#include <GLFW/glfw3.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct ShaderCompiler {
+    GLFWwindow* Window;
+    std::thread Thread;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    ShaderCompileRequest Request;
+    ShaderCompileResult Result;
+    std::vector<RenderPass> CurrentPasses;
+    std::vector<ShaderCompileRequest> PreloadRequests;
+    std::vector<ShaderCompileResult> PreloadResults;
+    std::vector<ShaderVariantRequest> VariantRequests;
+    std::vector<ShaderVariantResult> VariantResults;
+    FShaderCompileComplete OnComplete;
+    void* UserData;
+    int32_t CompilerThreads;
+    bool HasRequest;
+    bool HasResult;
+    bool IsAwaitingSwap;
+    bool IsCompiling;
+    bool IsCompilingRequest;
+    bool Quit;
+};
+
+static void Compile(const ShaderCompileRequest& request, const std::vector<RenderPass>& current_passes, ShaderCompileResult& result) {
+    result.Path = request.Path;
+    result.Components = request.Components;
+
+    if (!ShaderParserParse(request.BasePath, request.Path, result.Watches, result.RenderPasses, result.Components, result.Error)) {
+        RenderPassDestroy(result.RenderPasses);
+        return;
+    }
+
+    if (request.StripUnused) {
+        for (RenderPass& render_pass : result.RenderPasses) {
+            std::string stripped;
+            if (ShaderParserStripUnused(render_pass.ShaderSource, stripped)) {
+                render_pass.ShaderSource = std::move(stripped);
+            }
+        }
+    }
+
+    RenderPassReuse(result.RenderPasses, current_passes);
+
+    result.Success =
+        RenderPassCheckLimits(result.RenderPasses, GLResourceGetBudget(), request.ReservedBytes, result.Error) &&
+        RenderPassCreateShared(result.RenderPasses, result.Error);
+
+    if (!result.Success) {
+        RenderPassReleaseReused(result.RenderPasses);
+        RenderPassDestroy(result.RenderPasses);
+    }
+
+    // Uploads and links must be complete before the render context uses the objects
+    glFinish();
+}
+
+static void CompileVariants(const std::vector<ShaderVariantRequest>& requests, std::vector<ShaderVariantResult>& results) {
+    size_t first = results.size();
+    for (const ShaderVariantRequest& request : requests) {
+        ShaderVariantResult result;
+        result.Key = request.Key;
+        RenderPassBeginVariant(result.Program, request.FragmentSource);
+        results.push_back(result);
+    }
+
+    for (size_t i = first; i < results.size(); ++i) {
+        results[i].Success = ShaderProgramEnd(results[i].Program, results[i].Error);
+    }
+
+    glFinish();
+}
+
+static void PublishResult(ShaderCompiler* compiler, ShaderCompileResult& result) {
+    if (compiler->HasResult) {
+        // Superseded before the render thread picked it up
+        RenderPassReleaseReused(compiler->Result.RenderPasses);
+        RenderPassDestroy(compiler->Result.RenderPasses);
+    }
+
+    compiler->Result = std::move(result);
+    compiler->HasResult = true;
+}
+
+static void CompileThread(ShaderCompiler* compiler) {
+    glfwMakeContextCurrent(compiler->Window);
+    GLExtensionsSetCompilerThreads(compiler->CompilerThreads);
+
+    std::unique_lock<std::mutex> lock(compiler->Mutex);
+    while (true) {
+        compiler->Condition.wait(lock, [compiler]() {
+            bool can_compile_passes = compiler->HasRequest && !compiler->HasResult && !compiler->IsAwaitingSwap;
+            bool has_background_work = !compiler->PreloadRequests.empty() || !compiler->VariantRequests.empty();
+            return compiler->Quit || can_compile_passes || (!compiler->HasRequest && has_background_work);
+        });
+
+        if (compiler->Quit) {
+            break;
+        }
+
+        if (!compiler->HasRequest && !compiler->PreloadRequests.empty()) {
+            // One at a time, a request for the passes on screen may come in meanwhile
+            ShaderCompileRequest request = std::move(compiler->PreloadRequests.front());
+            compiler->PreloadRequests.erase(compiler->PreloadRequests.begin());
+            compiler->IsCompiling = true;
+            lock.unlock();
+
+            ShaderCompileResult result;
+            Compile(request, {}, result);
+
+            lock.lock();
+            compiler->IsCompiling = false;
+            compiler->PreloadResults.push_back(std::move(result));
+            lock.unlock();
+
+            compiler->OnComplete(compiler->UserData);
+
+            lock.lock();
+            continue;
+        }
+
+        if (!compiler->HasRequest) {
+            std::vector<ShaderVariantRequest> requests = std::move(compiler->VariantRequests);
+            compiler->VariantRequests.clear();
+            compiler->IsCompiling = true;
+            lock.unlock();
+
+            std::vector<ShaderVariantResult> results;
+            CompileVariants(requests, results);
+
+            lock.lock();
+            compiler->IsCompiling = false;
+            compiler->VariantResults.insert(compiler->VariantResults.end(), results.begin(), results.end());
+            lock.unlock();
+
+            compiler->OnComplete(compiler->UserData);
+
+            lock.lock();
+            continue;
+        }
+
+        ShaderCompileRequest request = std::move(compiler->Request);
+        std::vector<RenderPass> current_passes = compiler->CurrentPasses;
+        compiler->HasRequest = false;
+        compiler->IsCompiling = true;
+        compiler->IsCompilingRequest = true;
+        lock.unlock();
+
+        ShaderCompileResult result;
+        Compile(request, current_passes, result);
+
+        lock.lock();
+        compiler->IsCompiling = false;
+        compiler->IsCompilingRequest = false;
+        PublishResult(compiler, result);
+        lock.unlock();
+
+        compiler->OnComplete(compiler->UserData);
+
+        lock.lock();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+HShaderCompiler ShaderCompilerCreate(GLFWwindow* shared_window, int32_t compiler_threads, FShaderCompileComplete on_complete, void* user_data) {
+    ShaderCompiler* compiler = new ShaderCompiler();
+    compiler->OnComplete = on_complete;
+    compiler->UserData = user_data;
+    compiler->CompilerThreads = compiler_threads;
+    compiler->HasRequest = false;
+    compiler->HasResult = false;
+    compiler->IsAwaitingSwap = false;
+    compiler->IsCompiling = false;
+    compiler->IsCompilingRequest = false;
+    compiler->Quit = false;
+
+    // The context hints of the render window still apply, only the visibility changes
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    compiler->Window = glfwCreateWindow(1, 1, "live-glsl compiler", NULL, shared_window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if (compiler->Window) {
+        compiler->Thread = std::thread(CompileThread, compiler);
+    } else {
+        fprintf(stderr, "Failed to create a shared context, shaders are compiled on the render thread\n");
+        GLExtensionsSetCompilerThreads(compiler_threads);
+    }
+
+    return compiler;
+}
+
+void ShaderCompilerDestroy(HShaderCompiler handle) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+
+    if (compiler->Window) {
+        {
+            std::lock_guard<std::mutex> lock(compiler->Mutex);
+            compiler->Quit = true;
+        }
+        compiler->Condition.notify_one();
+        compiler->Thread.join();
+
+        glfwDestroyWindow(compiler->Window);
+    }
+
+    if (compiler->HasResult) {
+        RenderPassReleaseReused(compiler->Result.RenderPasses);
+        RenderPassDestroy(compiler->Result.RenderPasses);
+    }
+
+    for (ShaderCompileResult& result : compiler->PreloadResults) {
+        RenderPassDestroy(result.RenderPasses);
+    }
+
+    for (ShaderVariantResult& result : compiler->VariantResults) {
+        ShaderProgramDestroy(result.Program);
+    }
+
+    delete compiler;
+}
+
+void ShaderCompilerSubmit(HShaderCompiler handle, const ShaderCompileRequest& request) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+
+    if (!compiler->Window) {
+        ShaderCompileResult result;
+        Compile(request, compiler->CurrentPasses, result);
+        PublishResult(compiler, result);
+        return;
+    }
+
+    {
+        // A request still waiting for the worker is replaced by the newer one
+        std::lock_guard<std::mutex> lock(compiler->Mutex);
+        compiler->Request = request;
+        compiler->HasRequest = true;
+    }
+    compiler->Condition.notify_one();
+}
+
+bool ShaderCompilerPoll(HShaderCompiler handle, ShaderCompileResult& result) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+    std::lock_guard<std::mutex> lock(compiler->Mutex);
+
+    if (!compiler->HasResult) {
+        return false;
+    }
+
+    result = std::move(compiler->Result);
+    compiler->Result = ShaderCompileResult();
+    compiler->HasResult = false;
+    compiler->IsAwaitingSwap = true;
+    return true;
+}
+
+bool ShaderCompilerIsBusy(HShaderCompiler handle) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+    std::lock_guard<std::mutex> lock(compiler->Mutex);
+    return compiler->HasRequest || compiler->IsCompiling;
+}
+
+bool ShaderCompilerIsReloading(HShaderCompiler handle) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+    std::lock_guard<std::mutex> lock(compiler->Mutex);
+    return compiler->HasRequest || compiler->IsCompilingRequest || compiler->HasResult;
+}
+
+void ShaderCompilerSubmitPreload(HShaderCompiler handle, const ShaderCompileRequest& request) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+
+    if (!compiler->Window) {
+        ShaderCompileResult result;
+        Compile(request, {}, result);
+        compiler->PreloadResults.push_back(std::move(result));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(compiler->Mutex);
+        compiler->PreloadRequests.push_back(request);
+    }
+    compiler->Condition.notify_one();
+}
+
+bool ShaderCompilerPollPreloads(HShaderCompiler handle, std::vector<ShaderCompileResult>& results) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+    std::lock_guard<std::mutex> lock(compiler->Mutex);
+
+    if (compiler->PreloadResults.empty()) {
+        return false;
+    }
+
+    results = std::move(compiler->PreloadResults);
+    compiler->PreloadResults.clear();
+    return true;
+}
+
+void ShaderCompilerSubmitVariants(HShaderCompiler handle, const std::vector<ShaderVariantRequest>& requests) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+
+    if (!compiler->Window) {
+        CompileVariants(requests, compiler->VariantResults);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(compiler->Mutex);
+        compiler->VariantRequests.insert(compiler->VariantRequests.end(), requests.begin(), requests.end());
+    }
+    compiler->Condition.notify_one();
+}
+
+bool ShaderCompilerPollVariants(HShaderCompiler handle, std::vector<ShaderVariantResult>& results) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+    std::lock_guard<std::mutex> lock(compiler->Mutex);
+
+    if (compiler->VariantResults.empty()) {
+        return false;
+    }
+
+    results = std::move(compiler->VariantResults);
+    compiler->VariantResults.clear();
+    return true;
+}
+
+void ShaderCompilerSetCurrent(HShaderCompiler handle, const std::vector<RenderPass>& render_passes) {
+    ShaderCompiler* compiler = (ShaderCompiler*)handle;
+    {
+        std::lock_guard<std::mutex> lock(compiler->Mutex);
+        compiler->CurrentPasses = render_passes;
+        compiler->IsAwaitingSwap = false;
+    }
+    compiler->Condition.notify_one();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "renderpass.h"
+#include "gui.h"
+
+struct GLFWwindow;
+
+struct ShaderCompileRequest {
+    std::string BasePath;
+    std::string Path;
+    std::vector<GUIComponent> Components;
+    int64_t ReservedBytes {0};
+    bool StripUnused {false};
+};
+
+struct ShaderCompileResult {
+    bool Success {false};
+    std::string Path;
+    std::vector<RenderPass> RenderPasses;
+    std::vector<std::string> Watches;
+    std::vector<GUIComponent> Components;
+    std::string Error;
+};
+
+struct ShaderVariantRequest {
+    uint64_t Key {0};
+    std::string FragmentSource;
+};
+
+struct ShaderVariantResult {
+    uint64_t Key {0};
+    bool Success {false};
+    ShaderProgram Program;
+    std::string Error;
+};
+
+typedef void (*FShaderCompileComplete)(void* user_data);
+typedef void* HShaderCompiler;
+
+// Shaders are parsed, compiled and uploaded on a worker thread owning a hidden
+// window whose context is shared with the render window. Results are handed
+// back without framebuffers, which are not shared and are created on the
+// render thread. The next request waits until the previous result is swapped
+// in, so that objects it reuses stay alive. When the hidden window can not be created, requests are
+// compiled synchronously on the calling thread.
+HShaderCompiler ShaderCompilerCreate(GLFWwindow* shared_window, int32_t compiler_threads, FShaderCompileComplete on_complete, void* user_data);
+void ShaderCompilerDestroy(HShaderCompiler compiler);
+void ShaderCompilerSubmit(HShaderCompiler compiler, const ShaderCompileRequest& request);
+bool ShaderCompilerPoll(HShaderCompiler compiler, ShaderCompileResult& result);
+bool ShaderCompilerIsBusy(HShaderCompiler compiler);
+// True from the submission of a request until its result is polled
+bool ShaderCompilerIsReloading(HShaderCompiler compiler);
+// Must follow every successful poll once the result is swapped in, unchanged
+// passes of the next request reuse objects of these passes.
+void ShaderCompilerSetCurrent(HShaderCompiler compiler, const std::vector<RenderPass>& render_passes);
+// Preloads are requests that share nothing with the current passes, compiled one
+// at a time after any pending render pass request. The caller owns the polled
+// render passes, which have no framebuffers yet.
+void ShaderCompilerSubmitPreload(HShaderCompiler compiler, const ShaderCompileRequest& request);
+bool ShaderCompilerPollPreloads(HShaderCompiler compiler, std::vector<ShaderCompileResult>& results);
+// Variants are single programs built from a pass fragment source, compiled
+// after any pending render pass request. The caller owns the polled programs.
+void ShaderCompilerSubmitVariants(HShaderCompiler compiler, const std::vector<ShaderVariantRequest>& requests);
+bool ShaderCompilerPollVariants(HShaderCompiler compiler, std::vector<ShaderVariantResult>& results);
@@ -1,62 +1,110 @@
 #include "shaderparser.h"
 
 #include "utils.h"
+#include "includecache.h"
+#include "preprocessor.h"
+#include "texturecache.h"
 
 #include <fstream>
 #include <sstream>
-#include <regex>
+#include <string_view>
 #include <functional>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
+#include <cctype>
+#include <set>
+#include <unordered_map>
+#include <algorithm>
 
 typedef std::function<void(const std::string&, uint32_t)> FErrorReport;
 
-bool ShaderParserAmalgamate(const std::string& base_path, const std::string& path, std::vector<std::string>& watches, std::string& read_file_error, std::string& amalgamate) {
-    std::ifstream file;
+static bool IsSpace(char c) {
+    return isspace((unsigned char)c) != 0;
+}
 
-    file.open(path.c_str());
+// Files with #pragma once or an include guard are only pasted the first time they are included
+// in each render pass, as every pass is compiled on its own.
+// Lines in inactive conditional branches are left empty, the includes they hold are never read.
+// Conditionals must be closed in the file and the render pass that open them.
+static bool Amalgamate(const std::string& base_path, const std::string& path, std::vector<std::string>& watches, std::set<std::string>& pasted_once, Preprocessor& preprocessor, std::string& read_file_error, std::string& amalgamate) {
+    std::shared_ptr<const IncludeFile> file;
 
-    if (!file.is_open()) {
+    if (!IncludeCacheRead(path, file)) {
         read_file_error = "Unable read file at path " + path;
         return false;
     }
 
+    if (file->IsOnce && !pasted_once.insert(file->CanonicalPath).second) {
+        return true;
+    }
+
     watches.push_back(path);
 
-    std::string curr_buffer;
-    while (!file.eof()) {
-        getline(file, curr_buffer);
-        uint32_t current_char = 0;
+    std::string_view text = file->Text;
+    std::string replacement;
+    size_t offset = 0;
+    size_t edge = 0;
+    uint32_t line_number = 0;
+    size_t branches = preprocessor.Branches.size();
+    bool is_in_comment = preprocessor.IsInComment;
+    preprocessor.IsInComment = false;
+
+    while (true) {
+        for (; edge < file->Includes.size() && file->Includes[edge].Offset == offset; ++edge) {
+            if (!PreprocessorIsEmitting(preprocessor)) {
+                continue;
+            }
+
+            std::string include = base_path + PATH_DELIMITER + file->Includes[edge].Path;
 
-        while (isspace(curr_buffer[current_char])) {
-            ++current_char;
+            if (!Amalgamate(ExtractBasePath(include), include, watches, pasted_once, preprocessor, read_file_error, amalgamate)) {
+                return false;
+            }
         }
 
-        std::regex include_regex("#include\\s+\"([^\"]+)\"");
-        std::smatch include_match;
+        if (offset == text.size()) {
+            break;
+        }
 
-        if (std::regex_search(curr_buffer, include_match, include_regex)) {
-            std::string include = base_path + PATH_DELIMITER + std::string(include_match[1]);
+        size_t line_end = std::min(text.find('\n', offset), text.size());
+        std::string_view line = text.substr(offset, line_end - offset);
+        ++line_number;
 
-            if (!ShaderParserAmalgamate(ExtractBasePath(include), include, watches, read_file_error, amalgamate)) {
+        if (PreprocessorProcess(preprocessor, line, replacement)) {
+            amalgamate.append(replacement.empty() ? line : replacement);
+        }
+        if (preprocessor.IsPassEnded) {
+            if (!preprocessor.Branches.empty()) {
+                read_file_error = "Unterminated conditional before @pass_end at line " + std::to_string(line_number) + " of " + path;
                 return false;
             }
-        } else {
-            amalgamate += curr_buffer + '\n';
+            preprocessor.IsPassEnded = false;
+            pasted_once.clear();
+        }
+        if (line_end < text.size()) {
+            amalgamate.push_back('\n');
         }
+        offset = std::min(line_end + 1, text.size());
     }
 
-    file.close();
+    if (preprocessor.Branches.size() > branches) {
+        read_file_error = "Unterminated conditional in " + path;
+        return false;
+    }
+    preprocessor.IsInComment = is_in_comment;
 
     return true;
 }
 
-bool ShaderParserParseTextures(const std::string& base_path, const std::string& prev_line, const std::string& line, uint32_t current_char, uint32_t line_number, FErrorReport report_error, std::vector<std::string>& watches, std::vector<Texture>& textures) {
+bool ShaderParserAmalgamate(const std::string& base_path, const std::string& path, std::vector<std::string>& watches, std::string& read_file_error, std::string& amalgamate) {
+    std::set<std::string> pasted_once;
+    Preprocessor preprocessor;
+    return Amalgamate(base_path, path, watches, pasted_once, preprocessor, read_file_error, amalgamate);
+}
+
+bool ShaderParserParseTextures(const std::string& base_path, std::string_view prev_line, std::string_view line, uint32_t current_char, uint32_t line_number, FErrorReport report_error, std::vector<std::string>& watches, std::vector<Texture>& textures) {
     int last_parenthesis_index = -1;
     int first_parenthesis_index = -1;
 
-    std::string path = prev_line.substr(current_char + 5, std::string::npos);
+    std::string path(prev_line.substr(current_char + 5));
 
     for (int i = 0; i < path.size(); ++i) {
         if (path[i] == '(') first_parenthesis_index = i;
@@ -64,13 +112,29 @@ bool ShaderParserParseTextures(const std::string& base_path, const std::string&
     }
 
     if (last_parenthesis_index <= first_parenthesis_index) {
-        report_error("Path format should be @path(path): " + path, line_number);
+        report_error("Path format should be @path(path) or @path(path, compress): " + path, line_number);
         return false;
     }
 
     path = path.substr(first_parenthesis_index + 1, last_parenthesis_index - 1);
 
-    std::vector<std::string> uniform_tokens = SplitString(line,  ' ');
+    bool is_compressed = false;
+    size_t comma = path.find(',');
+    if (comma != std::string::npos) {
+        size_t option_start = path.find_first_not_of(" \t", comma + 1);
+        size_t option_end = path.find_last_not_of(" \t");
+        std::string option = option_start == std::string::npos ? "" : path.substr(option_start, option_end - option_start + 1);
+        if (option != "compress") {
+            report_error("Unknown @path option " + option + ", expected @path(path, compress)", line_number);
+            return false;
+        }
+
+        is_compressed = true;
+        path.erase(comma);
+        path.erase(path.find_last_not_of(" \t") + 1);
+    }
+
+    std::vector<std::string> uniform_tokens = SplitString(std::string(line),  ' ');
     if (uniform_tokens.size() != 3) {
         return false;
     }
@@ -81,17 +145,18 @@ bool ShaderParserParseTextures(const std::string& base_path, const std::string&
         return false;
     }
 
-    stbi_set_flip_vertically_on_load(true);
-
     Texture texture;
     std::string full_path = base_path + PATH_DELIMITER + path;
-    texture.Data = stbi_load(full_path.c_str(), &texture.Width, &texture.Height, &texture.Channels, 4);
 
-    if (!texture.Data) {
+    if (!TextureCacheLoad(full_path, is_compressed, texture.Image)) {
         report_error("Failed to load texture at path " + path, line_number);
         return false;
     }
+    texture.Width = texture.Image->Width;
+    texture.Height = texture.Image->Height;
+    texture.Channels = texture.Image->Channels;
     texture.Binding = uniform_tokens[2].substr(0, uniform_tokens[2].length() - 1);
+    texture.Path = path;
 
     textures.push_back(texture);
     watches.push_back(full_path);
@@ -99,14 +164,14 @@ bool ShaderParserParseTextures(const std::string& base_path, const std::string&
     return true;
 }
 
-bool ShaderParserParseRenderPass(const std::string& prev_line, const std::string& line, uint32_t current_char, uint32_t line_number, FErrorReport report_error, RenderPass& pass) {
+bool ShaderParserParseRenderPass(std::string_view prev_line, std::string_view line, uint32_t current_char, uint32_t line_number, FErrorReport report_error, RenderPass& pass) {
     char input[64] = {0};
     char output[64] = {0};
 
     uint32_t width = 0;
     uint32_t height = 0;
 
-    std::string args = prev_line.substr(current_char + 5, std::string::npos);
+    std::string args(prev_line.substr(current_char + 5));
 
     int scanned = sscanf(args.c_str(), "(%[^,], %[^,], %d, %d)", output, input, &width, &height);
     if (scanned != 4) {
@@ -144,6 +209,37 @@ bool ShaderParserParseRenderPass(const std::string& prev_line, const std::string
     return true;
 }
 
+enum EShaderAnnotation {
+    EShaderAnnotationNone,
+    EShaderAnnotationPath,
+    EShaderAnnotationPass,
+    EShaderAnnotationPassEnd,
+    EShaderAnnotationGUI,
+};
+
+static uint32_t IndentLength(std::string_view line) {
+    uint32_t current_char = 0;
+    while (current_char < line.size() && IsSpace(line[current_char])) {
+        ++current_char;
+    }
+    return current_char;
+}
+
+static EShaderAnnotation AnnotationType(std::string_view prev_line, uint32_t current_char) {
+    if (current_char >= prev_line.length() || prev_line[current_char] != '@') {
+        return EShaderAnnotationNone;
+    }
+
+    if (prev_line.substr(current_char + 1, current_char + 4) == "path") {
+        return EShaderAnnotationPath;
+    } else if (prev_line.substr(current_char + 1, current_char + 8) == "pass_end") {
+        return EShaderAnnotationPassEnd;
+    } else if (prev_line.substr(current_char + 1, current_char + 4) == "pass") {
+        return EShaderAnnotationPass;
+    }
+    return EShaderAnnotationGUI;
+}
+
 bool ShaderParserParse(const std::string& base_path, const std::string& path, std::vector<std::string>& watches, std::vector<RenderPass>& render_passes, std::vector<GUIComponent>& components, std::string& read_file_error) {
     std::string amalgamate;
 
@@ -156,66 +252,71 @@ bool ShaderParserParse(const std::string& base_path, const std::string& path, st
 
     uint32_t line_number = 0;
     std::string source;
-    std::string prev_line;
+    std::string_view prev_line;
     std::vector<Texture> textures;
+    std::vector<std::string> defines;
     RenderPass* pass = nullptr;
 
     auto report_error = [&](const std::string& error, uint32_t line_number) {
         read_file_error = error + " at line " + std::to_string(line_number);
     };
 
-    for (size_t i = 0; i < amalgamate.size(); ++i) {
-        std::string line;
+    source.reserve(amalgamate.size());
 
-        while (amalgamate[i] != '\n') {
-            line += amalgamate[i];
-            ++i;
-        }
+    // The amalgamate ends with a line feed that is not followed by another line
+    std::string_view remaining = amalgamate;
+    std::string_view line;
+    bool has_line = !remaining.empty();
 
-        uint32_t current_char = 0;
-        while (isspace(line[current_char])) {
-            ++current_char;
-        }
+    while (NextLine(remaining, line, has_line) && (has_line || !line.empty())) {
+        uint32_t current_char = IndentLength(line);
 
-        if (current_char < prev_line.length() && prev_line[current_char] == '@') {
-            if (prev_line.substr(current_char + 1, current_char + 4) == "path") {
-                if (!ShaderParserParseTextures(base_path, prev_line, line, current_char, line_number, report_error, watches, textures)) {
-                    return false;
-                }
-            } else if (prev_line.substr(current_char + 1, current_char + 8) == "pass_end") {
-                if (!pass) {
-                    report_error("@pass_end was declared without @pass", line_number);
-                    return false;
-                }
+        // Annotations apply to the next line, when it starts at the same column
+        EShaderAnnotation annotation = AnnotationType(prev_line, current_char);
+        if (annotation == EShaderAnnotationPath) {
+            if (!ShaderParserParseTextures(base_path, prev_line, line, current_char, line_number, report_error, watches, textures)) {
+                return false;
+            }
+        } else if (annotation == EShaderAnnotationPassEnd) {
+            if (!pass) {
+                report_error("@pass_end was declared without @pass", line_number);
+                return false;
+            }
 
-                pass->ShaderSource = std::move(source);
-                pass->Textures = std::move(textures);
+            pass->ShaderSource = std::move(source);
+            pass->Textures = std::move(textures);
+            pass->Defines = std::move(defines);
 
-                source.clear();
-                textures.clear();
+            source.clear();
+            textures.clear();
+            defines.clear();
 
-                pass = nullptr;
-            } else if (prev_line.substr(current_char + 1, current_char + 4) == "pass") {
-                RenderPass new_pass;
-                if (!ShaderParserParseRenderPass(prev_line, line, current_char, line_number, report_error, new_pass)) {
-                    return false;
-                }
+            pass = nullptr;
+        } else if (annotation == EShaderAnnotationPass) {
+            RenderPass new_pass;
+            if (!ShaderParserParseRenderPass(prev_line, line, current_char, line_number, report_error, new_pass)) {
+                return false;
+            }
 
-                render_passes.push_back(new_pass);
-                pass = &render_passes.back();
-            } else {
-                GUIComponent component;
-                std::string gui_component_line = prev_line.substr(current_char + 1, std::string::npos);
-                if (!GUIComponentParse(line_number, gui_component_line, line, previous_components, component, read_file_error)) {
-                    return false;
-                }
+            render_passes.push_back(new_pass);
+            pass = &render_passes.back();
+        } else if (annotation == EShaderAnnotationGUI) {
+            GUIComponent component;
+            std::string gui_component_line(prev_line.substr(current_char + 1));
+            if (!GUIComponentParse(line_number, gui_component_line, std::string(line), previous_components, component, read_file_error)) {
+                return false;
+            }
 
-                new_components.push_back(component);
+            if (GUIIsDefineType(component.Type)) {
+                defines.push_back(component.UniformName);
             }
+
+            new_components.push_back(component);
         }
 
-        if (line[current_char] != '@') {
-            source += line + "\n";
+        if (current_char == line.size() || line[current_char] != '@') {
+            source.append(line);
+            source += '\n';
         }
 
         prev_line = line;
@@ -223,13 +324,11 @@ bool ShaderParserParse(const std::string& base_path, const std::string& path, st
     }
 
     if (pass) {
-        uint32_t current_char = 0;
-        while (isspace(prev_line[current_char])) {
-            ++current_char;
-        }
+        uint32_t current_char = IndentLength(prev_line);
         if (current_char < prev_line.length() && prev_line[current_char] == '@') {
             pass->ShaderSource = std::move(source);
             pass->Textures = std::move(textures);
+            pass->Defines = std::move(defines);
         } else {
             read_file_error = "Render pass " + pass->Output + " was declared without @pass_end";
             return false;
@@ -239,9 +338,514 @@ bool ShaderParserParse(const std::string& base_path, const std::string& path, st
         render_passes.back().ShaderSource = std::move(source);
         render_passes.back().IsMain = true;
         render_passes.back().Textures = textures;
+        render_passes.back().Defines = defines;
     }
 
     components = std::move(new_components);
 
     return true;
 }
+
+static bool IsIdentifierChar(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+static bool IsTextureFetchFunction(const std::string& word) {
+    static const char* fetch_functions[] = {
+        "texture", "textureOffset", "textureLod", "textureLodOffset",
+        "textureGrad", "textureGradOffset", "textureProj", "textureProjOffset",
+        "textureProjLod", "textureProjLodOffset", "textureProjGrad", "textureProjGradOffset",
+        "texelFetch", "texelFetchOffset",
+    };
+    for (const char* fetch_function : fetch_functions) {
+        if (word == fetch_function) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ShaderParserInstrument(const std::string& source, std::string& instrumented, std::string& error) {
+    static const char* prefix =
+        "int live_glsl_loop_count = 0;\n"
+        "int live_glsl_fetch_count = 0;\n"
+        "vec4 live_glsl_fetch(vec4 v) { ++live_glsl_fetch_count; return v; }\n"
+        "ivec4 live_glsl_fetch(ivec4 v) { ++live_glsl_fetch_count; return v; }\n"
+        "uvec4 live_glsl_fetch(uvec4 v) { ++live_glsl_fetch_count; return v; }\n"
+        "float live_glsl_fetch(float v) { ++live_glsl_fetch_count; return v; }\n";
+    static const char* suffix =
+        "\nout vec4 live_glsl_heat;\n"
+        "void main() {\n"
+        "    live_glsl_main();\n"
+        "    live_glsl_heat = vec4(float(live_glsl_loop_count), float(live_glsl_fetch_count), 0.0, 1.0);\n"
+        "}\n";
+
+    struct Statement {
+        int ParenDepth;
+        int BraceDepth;
+    };
+
+    std::string body;
+    std::vector<int> fetch_depths;
+    std::vector<int> do_depths;
+    std::vector<Statement> loop_statements;
+    std::string previous_word;
+    // Start of the layout qualifier of the current global declaration
+    size_t layout_start = std::string::npos;
+    int paren_depth = 0;
+    int brace_depth = 0;
+    int loop_header_depth = -1;
+    bool expect_loop_header = false;
+    bool expect_loop_body = false;
+    bool expect_do_body = false;
+    bool after_do_body = false;
+    bool at_line_start = true;
+    bool has_prefix = false;
+    bool has_main = false;
+
+    size_t i = 0;
+    while (i < source.size()) {
+        char c = source[i];
+
+        // Comments and preprocessor directives are copied verbatim
+        if (c == '/' && i + 1 < source.size() && (source[i + 1] == '/' || source[i + 1] == '*')) {
+            size_t end = source[i + 1] == '/' ? source.find('\n', i) : source.find("*/", i + 2);
+            end = end == std::string::npos ? source.size() : end + (source[i + 1] == '/' ? 0 : 2);
+            body.append(source, i, end - i);
+            i = end;
+            continue;
+        }
+
+        if (at_line_start && c == '#') {
+            size_t end = i;
+            while (end < source.size() && (source[end] != '\n' || source[end - 1] == '\\')) {
+                ++end;
+            }
+            body.append(source, i, end - i);
+            i = end;
+            continue;
+        }
+
+        if (isspace((unsigned char)c)) {
+            at_line_start |= c == '\n';
+            body += c;
+            ++i;
+            continue;
+        }
+
+        at_line_start = false;
+
+        // Declarations go after the leading preprocessor directives, such as #extension
+        if (!has_prefix) {
+            body += prefix;
+            has_prefix = true;
+        }
+
+        if (expect_loop_body) {
+            expect_loop_body = false;
+            if (c == '{') {
+                if (expect_do_body) {
+                    do_depths.push_back(brace_depth);
+                }
+                body += "{ ++live_glsl_loop_count;";
+                ++brace_depth;
+                ++i;
+                expect_do_body = false;
+                continue;
+            } else if (c != ';') {
+                body += "{ ++live_glsl_loop_count; ";
+                loop_statements.push_back({paren_depth, brace_depth});
+            }
+            expect_do_body = false;
+        }
+
+        if (IsIdentifierChar(c)) {
+            size_t end = i;
+            while (end < source.size() && IsIdentifierChar(source[end])) {
+                ++end;
+            }
+            std::string word = source.substr(i, end - i);
+
+            size_t next = end;
+            while (next < source.size() && isspace((unsigned char)source[next])) {
+                ++next;
+            }
+            bool is_call = next < source.size() && source[next] == '(';
+
+            if (is_call && IsTextureFetchFunction(word)) {
+                body += "live_glsl_fetch(" + word;
+                fetch_depths.push_back(paren_depth);
+            } else if (word == "for" || (word == "while" && !after_do_body)) {
+                body += word;
+                expect_loop_header = true;
+            } else if (word == "do") {
+                body += word;
+                expect_loop_body = true;
+                expect_do_body = true;
+            } else if (word == "main" && previous_word == "void" && brace_depth == 0) {
+                body += "live_glsl_main";
+                has_main = true;
+            } else if (word == "out" && brace_depth == 0 && paren_depth == 0) {
+                // Outputs of the pass become plain globals, the only output is the heat value.
+                // A layout qualifier is not valid on a plain global and goes with it.
+                if (layout_start != std::string::npos) {
+                    body.erase(layout_start);
+                }
+            } else if (word == "layout" && brace_depth == 0 && paren_depth == 0) {
+                layout_start = body.size();
+                body += word;
+            } else {
+                body += word;
+            }
+
+            if (word != "layout" && brace_depth == 0 && paren_depth == 0) {
+                layout_start = std::string::npos;
+            }
+
+            previous_word = word;
+            after_do_body = false;
+            i = end;
+            continue;
+        }
+
+        after_do_body = false;
+        previous_word.clear();
+        body += c;
+        ++i;
+
+        switch (c) {
+            case '(':
+                if (expect_loop_header) {
+                    loop_header_depth = paren_depth;
+                    expect_loop_header = false;
+                }
+                ++paren_depth;
+                break;
+            case ')':
+                --paren_depth;
+                while (!fetch_depths.empty() && fetch_depths.back() == paren_depth) {
+                    body += ')';
+                    fetch_depths.pop_back();
+                }
+                if (loop_header_depth == paren_depth) {
+                    loop_header_depth = -1;
+                    expect_loop_body = true;
+                }
+                break;
+            case '{':
+                ++brace_depth;
+                break;
+            case '}':
+                --brace_depth;
+                if (!do_depths.empty() && do_depths.back() == brace_depth) {
+                    do_depths.pop_back();
+                    after_do_body = true;
+                }
+                break;
+            case ';':
+                while (!loop_statements.empty() && loop_statements.back().ParenDepth == paren_depth && loop_statements.back().BraceDepth == brace_depth) {
+                    body += " }";
+                    loop_statements.pop_back();
+                }
+                break;
+        }
+    }
+
+    if (!has_main) {
+        error = "Instrumentation requires a main function";
+        return false;
+    }
+
+    if (brace_depth != 0 || paren_depth != 0 || !loop_statements.empty() || !fetch_depths.empty()) {
+        error = "Instrumentation does not support this loop or texture fetch construct";
+        return false;
+    }
+
+    instrumented = body + suffix;
+    return true;
+}
+
+bool ShaderParserFreeze(const std::string& source, const std::vector<GUIComponent>& components, std::string& frozen) {
+    static const char* uniform_types[] = {"float", "vec2", "vec3", "vec4"};
+    bool has_frozen_uniform = false;
+    size_t line_start = 0;
+
+    frozen.clear();
+    frozen.reserve(source.size());
+
+    while (line_start < source.size()) {
+        size_t line_end = source.find('\n', line_start);
+        line_end = line_end == std::string::npos ? source.size() : line_end + 1;
+        std::string line = source.substr(line_start, line_end - line_start);
+        line_start = line_end;
+
+        std::vector<std::string> tokens = SplitString(line.substr(0, line.find_first_of("\r\n")), ' ');
+        const GUIComponent* frozen_component = nullptr;
+
+        if (tokens.size() == 3 && tokens[0] == "uniform" && tokens[2].back() == ';') {
+            std::string name = tokens[2].substr(0, tokens[2].length() - 1);
+            for (const GUIComponent& component : components) {
+                if (!GUIIsDefineType(component.Type) && component.UniformName == name && tokens[1] == uniform_types[component.UniformType]) {
+                    frozen_component = &component;
+                    break;
+                }
+            }
+        }
+
+        if (!frozen_component) {
+            frozen += line;
+            continue;
+        }
+
+        // The constructor takes care of turning the values into valid float literals
+        std::string declaration = "const " + tokens[1] + " " + frozen_component->UniformName + " = " + tokens[1] + "(";
+        for (uint32_t i = 0; i < GUIUniformVariableComponents(frozen_component->UniformType); ++i) {
+            char value[32];
+            snprintf(value, sizeof(value), i == 0 ? "%.9g" : ", %.9g", frozen_component->Data[i]);
+            declaration += value;
+        }
+        declaration += ");\n";
+
+        frozen += declaration;
+        has_frozen_uniform = true;
+    }
+
+    return has_frozen_uniform;
+}
+
+bool ShaderParserApplyDefines(const std::string& source, const std::vector<GUIComponent>& components, std::string& applied) {
+    bool has_applied_define = false;
+    size_t line_start = 0;
+
+    applied.clear();
+    applied.reserve(source.size());
+
+    while (line_start < source.size()) {
+        size_t line_end = source.find('\n', line_start);
+        line_end = line_end == std::string::npos ? source.size() : line_end + 1;
+        std::string line = source.substr(line_start, line_end - line_start);
+        line_start = line_end;
+
+        std::string content = line.substr(0, line.find_first_of("\r\n"));
+        size_t content_start = content.find_first_not_of(" \t");
+        std::vector<std::string> tokens = SplitString(content_start == std::string::npos ? "" : content.substr(content_start), ' ');
+        const GUIComponent* define_component = nullptr;
+
+        if (tokens.size() >= 2 && tokens[0] == "#define") {
+            for (const GUIComponent& component : components) {
+                if (GUIIsDefineType(component.Type) && component.UniformName == tokens[1]) {
+                    define_component = &component;
+                    break;
+                }
+            }
+        }
+
+        if (!define_component) {
+            applied += line;
+            continue;
+        }
+
+        has_applied_define = true;
+        if (define_component->Type == EGUIComponentTypeToggle) {
+            // An empty line keeps the line numbers of compile errors unchanged
+            applied += define_component->Data[0] != 0.0f ? line : "\n";
+            continue;
+        }
+
+        uint32_t index = (uint32_t)define_component->Data[0];
+        if (index < define_component->Choices.size()) {
+            applied += content.substr(0, content_start) + "#define " + define_component->UniformName + " " + define_component->Choices[index] + "\n";
+        } else {
+            applied += line;
+        }
+    }
+
+    return has_applied_define;
+}
+
+bool ShaderParserStripUnused(const std::string& source, std::string& stripped) {
+    // A top level declaration, or a preprocessor directive outside of any declaration,
+    // along with the comments and blank lines before it
+    struct Declaration {
+        size_t Begin;
+        size_t End;
+        std::string Name;
+        std::vector<std::string> Identifiers;
+        bool IsRemovable;
+    };
+
+    std::vector<Declaration> declarations;
+    Declaration declaration = {0, 0, "", {}, false};
+    std::string last_identifier;
+    uint32_t identifier_count = 0;
+    int depth = 0;
+    int conditional_depth = 0;
+    bool has_tokens = false;
+    bool has_assignment = false;
+    bool is_function = false;
+    bool is_constant = false;
+    bool is_balanced = true;
+    bool at_line_start = true;
+
+    auto end_declaration = [&](size_t end) {
+        declaration.End = end;
+        declaration.IsRemovable = (is_function || is_constant) && is_balanced && conditional_depth == 0 && declaration.Name != "main";
+        declarations.push_back(std::move(declaration));
+
+        declaration = {end, end, "", {}, false};
+        last_identifier.clear();
+        identifier_count = 0;
+        conditional_depth = 0;
+        has_tokens = has_assignment = is_function = is_constant = false;
+        is_balanced = true;
+    };
+
+    size_t i = 0;
+    while (i < source.size()) {
+        char c = source[i];
+
+        if (c == '/' && i + 1 < source.size() && (source[i + 1] == '/' || source[i + 1] == '*')) {
+            size_t end = source[i + 1] == '/' ? source.find('\n', i) : source.find("*/", i + 2);
+            i = end == std::string::npos ? source.size() : end + (source[i + 1] == '/' ? 0 : 2);
+            continue;
+        }
+
+        if (at_line_start && c == '#') {
+            size_t end = i;
+            while (end < source.size() && (source[end] != '\n' || source[end - 1] == '\\')) {
+                ++end;
+            }
+
+            std::string_view arguments;
+            std::string_view directive = PreprocessorDirective(std::string_view(source).substr(i, end - i), arguments);
+            if (directive == "if" || directive == "ifdef" || directive == "ifndef") {
+                ++conditional_depth;
+            } else if (directive == "endif") {
+                is_balanced &= --conditional_depth >= 0;
+            } else if (directive == "else" || directive == "elif") {
+                is_balanced &= conditional_depth > 0;
+            }
+
+            // Macros may call any function, their identifiers count as used
+            while (!arguments.empty()) {
+                std::string_view identifier = PreprocessorIdentifier(arguments);
+                if (identifier.empty()) {
+                    arguments.remove_prefix(1);
+                } else {
+                    declaration.Identifiers.emplace_back(identifier);
+                }
+            }
+
+            i = end;
+            if (!has_tokens && depth == 0) {
+                end_declaration(std::min(end + 1, source.size()));
+                i = declaration.Begin;
+                at_line_start = true;
+            }
+            continue;
+        }
+
+        if (isspace((unsigned char)c)) {
+            at_line_start |= c == '\n';
+            ++i;
+            continue;
+        }
+
+        at_line_start = false;
+        has_tokens = true;
+
+        if (IsIdentifierChar(c)) {
+            size_t end = i;
+            while (end < source.size() && IsIdentifierChar(source[end])) {
+                ++end;
+            }
+            std::string identifier = source.substr(i, end - i);
+            i = end;
+
+            if (depth == 0) {
+                is_constant |= identifier_count == 0 && identifier == "const";
+                last_identifier = identifier;
+                ++identifier_count;
+            }
+            declaration.Identifiers.push_back(std::move(identifier));
+            continue;
+        }
+
+        ++i;
+
+        if (c == '(' || c == '[' || c == '{') {
+            // A function declaration has its parameters before anything else, after its type and name
+            if (depth == 0 && c == '(' && !has_assignment && !is_function && identifier_count >= 2 && declaration.Name.empty()) {
+                is_function = true;
+                declaration.Name = last_identifier;
+            }
+            if (depth == 0 && c == '{' && !is_function) {
+                is_constant = false;
+            }
+            ++depth;
+        } else if (c == ')' || c == ']' || c == '}') {
+            --depth;
+            if (depth == 0 && c == '}' && is_function) {
+                end_declaration(i);
+            }
+        } else if (depth == 0 && c == '=') {
+            if (is_constant && !has_assignment && !is_function) {
+                declaration.Name = last_identifier;
+            }
+            has_assignment = true;
+        } else if (depth == 0 && c == ',' && !is_function) {
+            // Several constants declared at once are kept
+            is_constant = false;
+        } else if (depth == 0 && c == ';') {
+            end_declaration(i);
+        }
+    }
+
+    std::unordered_map<std::string, std::vector<size_t>> removable;
+    std::vector<std::string> used;
+    for (size_t index = 0; index < declarations.size(); ++index) {
+        Declaration& candidate = declarations[index];
+        if (candidate.IsRemovable && !candidate.Name.empty()) {
+            removable[candidate.Name].push_back(index);
+        } else {
+            candidate.IsRemovable = false;
+            used.insert(used.end(), candidate.Identifiers.begin(), candidate.Identifiers.end());
+        }
+    }
+
+    // Follows the names used from everything that is kept, starting from main
+    while (!used.empty()) {
+        std::string name = std::move(used.back());
+        used.pop_back();
+
+        auto it = removable.find(name);
+        if (it == removable.end()) {
+            continue;
+        }
+
+        for (size_t index : it->second) {
+            declarations[index].IsRemovable = false;
+            used.insert(used.end(), declarations[index].Identifiers.begin(), declarations[index].Identifiers.end());
+        }
+        removable.erase(it);
+    }
+
+    if (removable.empty()) {
+        return false;
+    }
+
+    // Removed declarations leave their line feeds, so that compiler errors keep their line numbers
+    stripped.clear();
+    stripped.reserve(source.size());
+    for (const Declaration& candidate : declarations) {
+        if (candidate.IsRemovable) {
+            stripped.append(std::count(source.begin() + candidate.Begin, source.begin() + candidate.End, '\n'), '\n');
+        } else {
+            stripped.append(source, candidate.Begin, candidate.End - candidate.Begin);
+        }
+    }
+    size_t end = declarations.empty() ? 0 : declarations.back().End;
+    stripped.append(source, end, std::string::npos);
+
+    return true;
+}
@@ -6,4 +6,24 @@
 #include "renderpass.h"
 #include "gui.h"
 
-bool ShaderParserParse(const std::string& base_path, const std::string& path, std::vector<std::string>& watches, std::vector<RenderPass>& render_passes, std::vector<GUIComponent>& components, std::string& read_file_error);
\ No newline at end of file
+bool ShaderParserParse(const std::string& base_path, const std::string& path, std::vector<std::string>& watches, std::vector<RenderPass>& render_passes, std::vector<GUIComponent>& components, std::string& read_file_error);
+
+// Builds a variant of a pass source that counts loop iterations and texture fetches
+// per pixel, and writes them to its only output instead of the pass color.
+bool ShaderParserInstrument(const std::string& source, std::string& instrumented, std::string& error);
+
+// Replaces the uniforms driven by GUI components with constants holding their
+// current values, so that the compiler can fold them. Returns false when the
+// source has no such uniform.
+bool ShaderParserFreeze(const std::string& source, const std::vector<GUIComponent>& components, std::string& frozen);
+
+// Rewrites the #define lines driven by toggle and choice components: a disabled
+// toggle removes its define, a choice sets the value it selects. Returns false
+// when the source has no such define.
+bool ShaderParserApplyDefines(const std::string& source, const std::vector<GUIComponent>& components, std::string& applied);
+
+// Removes the functions and constants that main can not reach, following the
+// names used by every other declaration and preprocessor directive. Removed
+// lines are left empty so that compiler errors keep their line numbers. Returns
+// false when nothing can be removed.
+bool ShaderParserStripUnused(const std::string& source, std::string& stripped);
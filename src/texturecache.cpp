@@ -0,0 +1,602 @@
+#include "texturecache.h"
+
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <stdio.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "glextensions.h"
+#include "textureencoder.h"
+#include "textureupload.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+static const uint32_t MaxDecodeThreads = 8;
+
+struct TextureCacheEntry {
+    std::shared_ptr<TextureImage> Image;
+    std::filesystem::file_time_type ModificationTime;
+    uintmax_t Size;
+    uint64_t LastUse;
+};
+
+struct ReleasedTexture {
+    GLuint Id;
+    int64_t Bytes;
+};
+
+// Rows are streamed to a texture of their own, which replaces the placeholder of
+// the image once complete
+struct TextureStream {
+    std::weak_ptr<TextureImage> Image;
+    TextureUpload Upload;
+    int64_t Bytes;
+};
+
+struct TextureCache {
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    std::condition_variable DecodedCondition;
+    std::unordered_map<std::string, TextureCacheEntry> Entries;
+    std::deque<std::weak_ptr<TextureImage>> Jobs;
+    std::vector<std::weak_ptr<TextureImage>> Decoded;
+    // Render thread only
+    std::deque<TextureStream> Streams;
+    // Images may be released on any thread, their textures are deleted on the render thread.
+    // Images are released without taking the cache lock, which may be held at the time.
+    std::mutex ReleasedMutex;
+    std::vector<ReleasedTexture> Released;
+    std::vector<std::thread> Threads;
+    TextureCacheStats Stats;
+    GLResourceStats Uploaded;
+    FTextureDecoded OnDecoded {nullptr};
+    void* UserData {nullptr};
+    int64_t Budget {256 * 1024 * 1024};
+    int64_t UploadBudget {16 * 1024 * 1024};
+    uint64_t Uses {0};
+    bool Quit {false};
+
+    ~TextureCache();
+};
+
+static TextureCache& GetTextureCache() {
+    static TextureCache cache;
+    return cache;
+}
+
+TextureCache::~TextureCache() {
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Quit = true;
+    }
+    Condition.notify_all();
+
+    for (std::thread& thread : Threads) {
+        thread.join();
+    }
+
+    Entries.clear();
+}
+
+static TextureFileInfo ImageInfo(const TextureImage& image) {
+    TextureFileInfo info;
+    info.Width = image.Width;
+    info.Height = image.Height;
+    info.Channels = image.Channels;
+    info.InternalFormat = image.InternalFormat;
+    info.Format = image.Format;
+    info.Type = image.Type;
+    return info;
+}
+
+static int64_t ImageBytes(const TextureImage& image) {
+    return (int64_t)TextureFilePixelBytes(ImageInfo(image));
+}
+
+static int64_t UploadedBytes(const TextureImage& image) {
+    return image.IsPlaceholder ? GLResourceTextureBytes(1, 1, GL_RGBA8) : GLResourceTextureBytes(image.Width, image.Height, image.InternalFormat);
+}
+
+static int FormatComponents(GLenum format) {
+    return format == GL_RED ? 1 : format == GL_RG ? 2 : format == GL_RGB ? 3 : 4;
+}
+
+// Single and two channel images are spread over the color by swizzles, the way
+// luminance and luminance alpha formats were, and expanded to four channels on
+// contexts without them
+static void ChooseFormat(TextureImage& image, bool is_16_bit) {
+    static const GLenum formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    static const GLenum internal_formats_8[] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    static const GLenum internal_formats_16[] = {GL_R16, GL_RG16, GL_RGB16, GL_RGBA16};
+
+    const GLExtensions& extensions = GLExtensionsGet();
+    int components = std::max(1, std::min(image.Channels, 4));
+
+    // RGTC is core but only holds one or two channels, the other images need S3TC.
+    // Compressed textures hold 8 bits per channel.
+    if (image.IsCompressed) {
+        GLenum compressed_format = GL_NONE;
+        GLenum format = GL_NONE;
+        if (components <= 2 && extensions.TextureSwizzle) {
+            compressed_format = components == 1 ? GL_COMPRESSED_RED_RGTC1 : GL_COMPRESSED_RG_RGTC2;
+            format = components == 1 ? GL_RED : GL_RG;
+        } else if (extensions.TextureCompressionS3TC) {
+            bool has_alpha = components == 2 || components == 4;
+            compressed_format = has_alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            format = has_alpha ? GL_RGBA : GL_RGB;
+        }
+
+        if (compressed_format != GL_NONE) {
+            image.Format = format;
+            image.InternalFormat = compressed_format;
+            image.Type = GL_UNSIGNED_BYTE;
+            return;
+        }
+    }
+
+    if (components <= 2 && !extensions.TextureSwizzle) {
+        components = 4;
+    }
+
+    image.Format = formats[components - 1];
+    image.InternalFormat = is_16_bit ? internal_formats_16[components - 1] : internal_formats_8[components - 1];
+    image.Type = is_16_bit ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+}
+
+// Swaps rows from both ends towards the middle, which leaves the decoder free of
+// the process wide flip flag of stb
+static void FlipVertically(unsigned char* pixels, size_t row_bytes, int height) {
+    for (int y = 0; y < height / 2; ++y) {
+        unsigned char* top = pixels + (size_t)y * row_bytes;
+        unsigned char* bottom = pixels + (size_t)(height - 1 - y) * row_bytes;
+        size_t x = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; x + 16 <= row_bytes; x += 16) {
+            __m128i top_bytes = _mm_loadu_si128((const __m128i*)(top + x));
+            __m128i bottom_bytes = _mm_loadu_si128((const __m128i*)(bottom + x));
+            _mm_storeu_si128((__m128i*)(top + x), bottom_bytes);
+            _mm_storeu_si128((__m128i*)(bottom + x), top_bytes);
+        }
+#endif
+        for (; x < row_bytes; ++x) {
+            std::swap(top[x], bottom[x]);
+        }
+    }
+}
+
+TextureImage::~TextureImage() {
+    if (Id != 0) {
+        TextureCache& cache = GetTextureCache();
+        std::lock_guard<std::mutex> lock(cache.ReleasedMutex);
+        cache.Released.push_back({Id, UploadedBytes(*this)});
+    }
+
+    if (File.Mapping) {
+        TextureFileClose(File);
+    } else {
+        stbi_image_free((void*)Data);
+    }
+}
+
+static void DecodeThread(TextureCache* cache) {
+    std::unique_lock<std::mutex> lock(cache->Mutex);
+
+    while (true) {
+        cache->Condition.wait(lock, [cache] { return cache->Quit || !cache->Jobs.empty(); });
+        if (cache->Quit) {
+            return;
+        }
+
+        std::shared_ptr<TextureImage> image = cache->Jobs.front().lock();
+        cache->Jobs.pop_front();
+        if (!image) {
+            // Evicted before it was decoded
+            continue;
+        }
+
+        lock.unlock();
+
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        bool is_compressed = TextureEncoderIsCompressed(image->InternalFormat);
+        int components = is_compressed ? TextureEncoderComponents(image->InternalFormat) : FormatComponents(image->Format);
+        bool is_16_bit = image->Type == GL_UNSIGNED_SHORT;
+        unsigned char* data = is_16_bit ?
+            (unsigned char*)stbi_load_16(image->Path.c_str(), &width, &height, &channels, components) :
+            stbi_load(image->Path.c_str(), &width, &height, &channels, components);
+
+        bool is_decoded = data && width == image->Width && height == image->Height;
+        if (!is_decoded) {
+            fprintf(stderr, "Failed to decode texture at path %s: %s\n", image->Path.c_str(), data ? "file changed" : stbi_failure_reason());
+            stbi_image_free(data);
+            data = nullptr;
+        } else {
+            FlipVertically(data, (size_t)width * components * (is_16_bit ? 2 : 1), height);
+
+            if (is_compressed) {
+                // Allocated like the decoded pixels, so that both are freed the same way
+                unsigned char* blocks = (unsigned char*)STBI_MALLOC(TextureEncoderBytes(image->InternalFormat, width, height));
+                TextureEncoderEncode(image->InternalFormat, data, width, height, blocks);
+                stbi_image_free(data);
+                data = blocks;
+            }
+
+            if (!image->Source.CanonicalPath.empty()) {
+                TextureFileStore(image->Source, ImageInfo(*image), data);
+            }
+        }
+
+        lock.lock();
+        image->Data = data;
+        image->State.store(is_decoded ? ETextureImageStateDecoded : ETextureImageStateFailed);
+        if (is_decoded) {
+            cache->Decoded.push_back(image);
+        }
+
+        // Released before waiters wake up, so that they may hold the last reference
+        image.reset();
+        cache->DecodedCondition.notify_all();
+
+        if (cache->OnDecoded) {
+            cache->OnDecoded(cache->UserData);
+        }
+    }
+}
+
+// Images still used by a pass stay alive when evicted, only unused ones free memory
+static void Trim(TextureCache& cache) {
+    while (cache.Stats.Bytes > cache.Budget) {
+        auto oldest = cache.Entries.end();
+        for (auto it = cache.Entries.begin(); it != cache.Entries.end(); ++it) {
+            if (it->second.Image.use_count() == 1 && (oldest == cache.Entries.end() || it->second.LastUse < oldest->second.LastUse)) {
+                oldest = it;
+            }
+        }
+
+        if (oldest == cache.Entries.end()) {
+            return;
+        }
+
+        cache.Stats.Bytes -= ImageBytes(*oldest->second.Image);
+        cache.Entries.erase(oldest);
+    }
+}
+
+bool TextureCacheLoad(const std::string& path, bool is_compressed, std::shared_ptr<TextureImage>& image) {
+    TextureCache& cache = GetTextureCache();
+
+    std::error_code error;
+    std::filesystem::path canonical_path = std::filesystem::weakly_canonical(path, error);
+    std::string canonical = error ? path : canonical_path.string();
+    std::string key = is_compressed ? canonical + "|compressed" : canonical;
+
+    std::filesystem::file_time_type modification_time = std::filesystem::last_write_time(path, error);
+    uintmax_t size = error ? 0 : std::filesystem::file_size(path, error);
+    bool has_status = !error;
+
+    bool is_racy = has_status && std::filesystem::file_time_type::clock::now() - modification_time < std::chrono::seconds(2);
+
+    if (has_status) {
+        std::lock_guard<std::mutex> lock(cache.Mutex);
+        auto it = cache.Entries.find(key);
+        if (it != cache.Entries.end() && !is_racy && it->second.ModificationTime == modification_time && it->second.Size == size &&
+            it->second.Image->State != ETextureImageStateFailed) {
+            ++cache.Stats.Hits;
+            it->second.LastUse = ++cache.Uses;
+            image = it->second.Image;
+            return true;
+        }
+    }
+
+    std::shared_ptr<TextureImage> loaded = std::make_shared<TextureImage>();
+    loaded->Path = path;
+    loaded->IsCompressed = is_compressed;
+    if (has_status && !is_racy) {
+        loaded->Source.CanonicalPath = canonical;
+        loaded->Source.IsCompressed = is_compressed;
+        loaded->Source.ModificationTime = (int64_t)modification_time.time_since_epoch().count();
+        loaded->Source.Size = size;
+    }
+
+    bool is_mapped = !loaded->Source.CanonicalPath.empty() && TextureFileOpen(loaded->Source, loaded->File);
+    if (is_mapped) {
+        loaded->Channels = loaded->File.Info.Channels;
+        ChooseFormat(*loaded, loaded->File.Info.Type == GL_UNSIGNED_SHORT);
+
+        // Stored from a context that did not support the same formats
+        if (loaded->InternalFormat != loaded->File.Info.InternalFormat || loaded->Format != loaded->File.Info.Format) {
+            TextureFileClose(loaded->File);
+            is_mapped = false;
+        }
+    }
+
+    if (is_mapped) {
+        loaded->Width = loaded->File.Info.Width;
+        loaded->Height = loaded->File.Info.Height;
+        loaded->Data = loaded->File.Pixels;
+        loaded->State.store(ETextureImageStateDecoded);
+    } else if (stbi_info(path.c_str(), &loaded->Width, &loaded->Height, &loaded->Channels)) {
+        ChooseFormat(*loaded, stbi_is_16_bit(path.c_str()) != 0);
+    } else {
+        // Only the header is read here, so that a broken file is reported with the shader
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cache.Mutex);
+        if (is_mapped) {
+            ++cache.Stats.Mapped;
+        } else {
+            ++cache.Stats.Decodes;
+
+            if (cache.Threads.empty()) {
+                uint32_t thread_count = std::max(1u, std::min(std::thread::hardware_concurrency(), MaxDecodeThreads));
+                for (uint32_t i = 0; i < thread_count; ++i) {
+                    cache.Threads.emplace_back(DecodeThread, &cache);
+                }
+            }
+
+            cache.Jobs.push_back(loaded);
+            cache.Condition.notify_one();
+        }
+
+        if (has_status) {
+            auto it = cache.Entries.find(key);
+            if (it != cache.Entries.end()) {
+                cache.Stats.Bytes -= ImageBytes(*it->second.Image);
+            }
+
+            cache.Entries[key] = {loaded, modification_time, size, ++cache.Uses};
+            cache.Stats.Bytes += ImageBytes(*loaded);
+            Trim(cache);
+        }
+    }
+
+    image = std::move(loaded);
+    return true;
+}
+
+static void UploadPixels(TextureCache& cache, TextureImage& image) {
+    static const unsigned char placeholder[4] = {0, 0, 0, 255};
+
+    cache.Uploaded.Bytes[EGLResourceTypeTexture] -= UploadedBytes(image);
+    image.IsPlaceholder = image.State != ETextureImageStateDecoded;
+    cache.Uploaded.Bytes[EGLResourceTypeTexture] += UploadedBytes(image);
+
+    int width = image.IsPlaceholder ? 1 : image.Width;
+    int height = image.IsPlaceholder ? 1 : image.Height;
+    GLenum internal_format = image.IsPlaceholder ? GL_RGBA8 : image.InternalFormat;
+
+    glBindTexture(GL_TEXTURE_2D, image.Id);
+    // Rows of single channel and RGB images are not padded to four bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (image.IsPlaceholder) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+    } else if (TextureEncoderIsCompressed(image.InternalFormat)) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, image.InternalFormat, width, height, 0, (GLsizei)ImageBytes(image), image.Data);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, image.InternalFormat, width, height, 0, image.Format, image.Type, image.Data);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GLResourceDescribe(EGLResourceTypeTexture, image.Id, GLResourceTextureInfo("textures", image.Path, width, height, internal_format));
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static GLuint CreateTexture(const TextureImage& image) {
+    GLuint id = GLResourceCreate(EGLResourceTypeTexture);
+
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Only chosen when swizzles are supported
+    if (image.Format == GL_RED || image.Format == GL_RG) {
+        GLint swizzle[4] = {GL_RED, GL_RED, GL_RED, image.Format == GL_RED ? GL_ONE : GL_GREEN};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return id;
+}
+
+// The image keeps its placeholder while the rows are streamed by the next updates,
+// so that passes never sample rows not uploaded yet
+static void BeginStream(TextureCache& cache, TextureImage& image) {
+    TextureStream stream;
+    stream.Image = image.weak_from_this();
+    stream.Bytes = GLResourceTextureBytes(image.Width, image.Height, image.InternalFormat);
+    stream.Upload.Id = CreateTexture(image);
+    stream.Upload.InternalFormat = image.InternalFormat;
+    stream.Upload.Format = image.Format;
+    stream.Upload.Type = image.Type;
+    stream.Upload.Width = image.Width;
+    stream.Upload.Height = image.Height;
+    stream.Upload.Pixels = image.Data;
+
+    TextureUploadBegin(stream.Upload);
+    GLResourceDescribe(EGLResourceTypeTexture, stream.Upload.Id, GLResourceTextureInfo("textures", image.Path, image.Width, image.Height, image.InternalFormat));
+    ++cache.Uploaded.Count[EGLResourceTypeTexture];
+    cache.Uploaded.Bytes[EGLResourceTypeTexture] += stream.Bytes;
+    cache.Streams.push_back(stream);
+}
+
+static void CancelStream(TextureCache& cache, TextureStream& stream) {
+    --cache.Uploaded.Count[EGLResourceTypeTexture];
+    cache.Uploaded.Bytes[EGLResourceTypeTexture] -= stream.Bytes;
+    GLResourceDestroy(EGLResourceTypeTexture, stream.Upload.Id);
+}
+
+// The streamed texture takes the place of the placeholder, which is deleted
+static void EndStream(TextureCache& cache, const TextureStream& stream, TextureImage& image) {
+    --cache.Uploaded.Count[EGLResourceTypeTexture];
+    cache.Uploaded.Bytes[EGLResourceTypeTexture] -= UploadedBytes(image);
+    GLResourceDestroy(EGLResourceTypeTexture, image.Id);
+
+    image.Id = stream.Upload.Id;
+    image.IsPlaceholder = false;
+}
+
+// Streams are served in the order the images were decoded, so that one image is
+// complete before the next one starts
+static bool Stream(TextureCache& cache) {
+    bool is_unlimited = cache.UploadBudget <= 0;
+    int64_t budget = is_unlimited ? INT64_MAX : cache.UploadBudget;
+    bool has_changed = false;
+
+    while (!cache.Streams.empty() && budget > 0) {
+        TextureStream& stream = cache.Streams.front();
+        std::shared_ptr<TextureImage> image = stream.Image.lock();
+        if (!image) {
+            CancelStream(cache, stream);
+            cache.Streams.pop_front();
+            continue;
+        }
+
+        if (!TextureUploadStream(stream.Upload, budget, is_unlimited)) {
+            // Out of budget, or the ring is busy until the GPU catches up
+            break;
+        }
+        EndStream(cache, stream, *image);
+        cache.Streams.pop_front();
+        has_changed = true;
+    }
+
+    return has_changed;
+}
+
+GLuint TextureCacheUpload(TextureImage& image) {
+    TextureCache& cache = GetTextureCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+
+    if (image.Id != 0) {
+        return image.Id;
+    }
+
+    image.Id = CreateTexture(image);
+    image.IsPlaceholder = true;
+    ++cache.Uploaded.Count[EGLResourceTypeTexture];
+    cache.Uploaded.Bytes[EGLResourceTypeTexture] += UploadedBytes(image);
+
+    UploadPixels(cache, image);
+
+    return image.Id;
+}
+
+GLuint TextureCacheGetId(const TextureImage& image) {
+    TextureCache& cache = GetTextureCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    return image.Id;
+}
+
+bool TextureCacheUpdate() {
+    TextureCache& cache = GetTextureCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    bool has_changed = false;
+
+    // Images without a texture yet are uploaded in full when they get one, off the render thread
+    for (const std::weak_ptr<TextureImage>& weak_image : cache.Decoded) {
+        std::shared_ptr<TextureImage> image = weak_image.lock();
+        if (image && image->Id != 0 && image->IsPlaceholder) {
+            BeginStream(cache, *image);
+        }
+    }
+    cache.Decoded.clear();
+
+    has_changed |= Stream(cache);
+
+    std::vector<ReleasedTexture> released_textures;
+    {
+        std::lock_guard<std::mutex> released_lock(cache.ReleasedMutex);
+        released_textures.swap(cache.Released);
+    }
+
+    has_changed |= !released_textures.empty();
+    for (ReleasedTexture& released : released_textures) {
+        --cache.Uploaded.Count[EGLResourceTypeTexture];
+        cache.Uploaded.Bytes[EGLResourceTypeTexture] -= released.Bytes;
+        GLResourceDestroy(EGLResourceTypeTexture, released.Id);
+    }
+
+    return has_changed;
+}
+
+bool TextureCacheWait(const TextureImage& image) {
+    TextureCache& cache = GetTextureCache();
+    std::unique_lock<std::mutex> lock(cache.Mutex);
+    cache.DecodedCondition.wait(lock, [&image] { return image.State != ETextureImageStateDecoding; });
+    return image.State == ETextureImageStateDecoded;
+}
+
+void TextureCacheSetUploadBudget(int64_t bytes_per_frame) {
+    TextureCache& cache = GetTextureCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    cache.UploadBudget = bytes_per_frame;
+}
+
+bool TextureCacheIsUploading() {
+    TextureCache& cache = GetTextureCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    return !cache.Streams.empty();
+}
+
+void TextureCacheSetDecodedCallback(FTextureDecoded on_decoded, void* user_data) {
+    TextureCache& cache = GetTextureCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    cache.OnDecoded = on_decoded;
+    cache.UserData = user_data;
+}
+
+void TextureCacheSetBudget(int64_t budget_bytes) {
+    TextureCache& cache = GetTextureCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    cache.Budget = budget_bytes;
+    Trim(cache);
+}
+
+TextureCacheStats TextureCacheGetStats() {
+    TextureCache& cache = GetTextureCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    TextureCacheStats stats = cache.Stats;
+    stats.Textures = (uint32_t)cache.Entries.size();
+    return stats;
+}
+
+GLResourceStats TextureCacheResourceStats() {
+    TextureCache& cache = GetTextureCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    GLResourceStats stats = cache.Uploaded;
+    GLResourceStats ring = TextureUploadResourceStats();
+    stats.Count[EGLResourceTypeBuffer] += ring.Count[EGLResourceTypeBuffer];
+    stats.Bytes[EGLResourceTypeBuffer] += ring.Bytes[EGLResourceTypeBuffer];
+    return stats;
+}
+
+void TextureCacheClear() {
+    TextureCache& cache = GetTextureCache();
+    {
+        std::lock_guard<std::mutex> lock(cache.Mutex);
+        cache.Entries.clear();
+        cache.Decoded.clear();
+        for (TextureStream& stream : cache.Streams) {
+            CancelStream(cache, stream);
+        }
+        cache.Streams.clear();
+        cache.Stats = TextureCacheStats();
+    }
+
+    TextureCacheUpdate();
+    TextureUploadDestroy();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <stdint.h>
+
+#include <glad/gl.h>
+
+#include "glresource.h"
+#include "texturefile.h"
+
+enum ETextureImageState {
+    ETextureImageStateDecoding,
+    ETextureImageStateDecoded,
+    ETextureImageStateFailed,
+};
+
+// Decoded pixels of an image file, in its own channel count and bit depth, and the
+// texture they are uploaded to.
+// The size is read from the file header, the pixels are decoded in the background,
+// or mapped from a texture file stored by a previous decode.
+struct TextureImage : std::enable_shared_from_this<TextureImage> {
+    std::string Path;
+    // Left without a path when the image file changed too recently to be identified
+    TextureFileSource Source;
+    TextureFile File;
+    int Width {0};
+    int Height {0};
+    // Channels of the file, the pixels have four when swizzles are not supported
+    // to spread a single or two channels over the color
+    int Channels {0};
+    GLenum InternalFormat {GL_RGBA8};
+    GLenum Format {GL_RGBA};
+    GLenum Type {GL_UNSIGNED_BYTE};
+    // Requested with @path(file, compress), the pixels are then encoded into blocks
+    // of a compressed format when the context supports one for the channels
+    bool IsCompressed {false};
+    // Bottom row first, as expected by glTexImage2D
+    const unsigned char* Data {nullptr};
+    std::atomic<int> State {ETextureImageStateDecoding};
+    // Written under the cache lock, read through TextureCacheGetId off the render thread
+    GLuint Id {0};
+    // The texture holds a single texel until the pixels are uploaded. Streamed pixels
+    // go to another texture, which replaces it once every row is uploaded.
+    bool IsPlaceholder {false};
+
+    ~TextureImage();
+};
+
+struct TextureCacheStats {
+    uint32_t Textures {0};
+    int64_t Bytes {0};
+    uint64_t Decodes {0};
+    uint64_t Mapped {0};
+    uint64_t Hits {0};
+};
+
+typedef void (*FTextureDecoded)(void* user_data);
+
+// Images are shared by every pass and reload using the same file, they are only
+// decoded again when the modification time or size of the file changes. Images
+// no pass uses are kept until the budget is exceeded, the least recently used
+// first to go. Fails when the file header can not be read. Compressed images are
+// cached apart from the uncompressed ones of the same file.
+bool TextureCacheLoad(const std::string& path, bool is_compressed, std::shared_ptr<TextureImage>& image);
+// Creates the texture of an image on the first call, on a context sharing its
+// objects with the render context. An image still decoding gets a placeholder.
+GLuint TextureCacheUpload(TextureImage& image);
+// Texture of an image, 0 until it is uploaded
+GLuint TextureCacheGetId(const TextureImage& image);
+// Called on the render thread: streams the pixels of the images decoded since the
+// last update, within the upload budget of a frame, and deletes the textures of
+// released images. The id of an image changes once its stream completes, passes
+// read it again when binding. Returns true when a texture changed.
+bool TextureCacheUpdate();
+// Bytes streamed to textures by each update, 0 uploads everything at once
+void TextureCacheSetUploadBudget(int64_t bytes_per_frame);
+// True while rows of a texture are left to stream by the next updates
+bool TextureCacheIsUploading();
+// Blocks until the image is decoded, returns false when decoding failed
+bool TextureCacheWait(const TextureImage& image);
+// Called from a decoding thread each time an image is decoded
+void TextureCacheSetDecodedCallback(FTextureDecoded on_decoded, void* user_data);
+void TextureCacheSetBudget(int64_t budget_bytes);
+TextureCacheStats TextureCacheGetStats();
+// Textures of every image still alive, whether cached or not, and the upload buffers
+GLResourceStats TextureCacheResourceStats();
+// Must be called while a context is current, before it is destroyed
+void TextureCacheClear();
@@ -0,0 +1,251 @@
+#include "textureencoder.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXTURE_ENCODER_SSE2
+#endif
+
+static const int MinBlockRowsPerThread = 16;
+
+bool TextureEncoderIsCompressed(GLenum internal_format) {
+    switch (internal_format) {
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int TextureEncoderComponents(GLenum internal_format) {
+    switch (internal_format) {
+        case GL_COMPRESSED_RED_RGTC1: return 1;
+        case GL_COMPRESSED_RG_RGTC2: return 2;
+        default: return 4;
+    }
+}
+
+static size_t BlockBytes(GLenum internal_format) {
+    return internal_format == GL_COMPRESSED_RED_RGTC1 || internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+}
+
+size_t TextureEncoderBytes(GLenum internal_format, int width, int height) {
+    return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * BlockBytes(internal_format);
+}
+
+static void MinMaxValues(const unsigned char values[16], unsigned char& min_value, unsigned char& max_value) {
+#ifdef TEXTURE_ENCODER_SSE2
+    __m128i min_values = _mm_loadu_si128((const __m128i*)values);
+    __m128i max_values = min_values;
+    min_values = _mm_min_epu8(min_values, _mm_srli_si128(min_values, 8));
+    max_values = _mm_max_epu8(max_values, _mm_srli_si128(max_values, 8));
+    min_values = _mm_min_epu8(min_values, _mm_srli_si128(min_values, 4));
+    max_values = _mm_max_epu8(max_values, _mm_srli_si128(max_values, 4));
+    min_values = _mm_min_epu8(min_values, _mm_srli_si128(min_values, 2));
+    max_values = _mm_max_epu8(max_values, _mm_srli_si128(max_values, 2));
+    min_values = _mm_min_epu8(min_values, _mm_srli_si128(min_values, 1));
+    max_values = _mm_max_epu8(max_values, _mm_srli_si128(max_values, 1));
+    min_value = (unsigned char)(_mm_cvtsi128_si32(min_values) & 0xFF);
+    max_value = (unsigned char)(_mm_cvtsi128_si32(max_values) & 0xFF);
+#else
+    min_value = max_value = values[0];
+    for (int i = 1; i < 16; ++i) {
+        min_value = std::min(min_value, values[i]);
+        max_value = std::max(max_value, values[i]);
+    }
+#endif
+}
+
+static void MinMaxColors(const unsigned char texels[64], unsigned char min_color[4], unsigned char max_color[4]) {
+#ifdef TEXTURE_ENCODER_SSE2
+    __m128i min_colors = _mm_loadu_si128((const __m128i*)texels);
+    __m128i max_colors = min_colors;
+    for (int i = 1; i < 4; ++i) {
+        __m128i colors = _mm_loadu_si128((const __m128i*)(texels + i * 16));
+        min_colors = _mm_min_epu8(min_colors, colors);
+        max_colors = _mm_max_epu8(max_colors, colors);
+    }
+    min_colors = _mm_min_epu8(min_colors, _mm_srli_si128(min_colors, 8));
+    max_colors = _mm_max_epu8(max_colors, _mm_srli_si128(max_colors, 8));
+    min_colors = _mm_min_epu8(min_colors, _mm_srli_si128(min_colors, 4));
+    max_colors = _mm_max_epu8(max_colors, _mm_srli_si128(max_colors, 4));
+
+    uint32_t min_packed = (uint32_t)_mm_cvtsi128_si32(min_colors);
+    uint32_t max_packed = (uint32_t)_mm_cvtsi128_si32(max_colors);
+    memcpy(min_color, &min_packed, 4);
+    memcpy(max_color, &max_packed, 4);
+#else
+    memcpy(min_color, texels, 4);
+    memcpy(max_color, texels, 4);
+    for (int i = 1; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            min_color[c] = std::min(min_color[c], texels[i * 4 + c]);
+            max_color[c] = std::max(max_color[c], texels[i * 4 + c]);
+        }
+    }
+#endif
+}
+
+// Both end points are the extremes of the block, with the six interpolated values
+// between them. Also encodes the alpha of BC3.
+static void EncodeChannelBlock(const unsigned char values[16], unsigned char* block) {
+    unsigned char min_value;
+    unsigned char max_value;
+    MinMaxValues(values, min_value, max_value);
+
+    block[0] = max_value;
+    block[1] = min_value;
+
+    uint64_t indices = 0;
+    if (max_value > min_value) {
+        int range = max_value - min_value;
+        for (int i = 0; i < 16; ++i) {
+            // Steps from the first end point towards the second, the end points come first in the palette
+            int step = ((max_value - values[i]) * 7 + range / 2) / range;
+            uint64_t index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+            indices |= index << (3 * i);
+        }
+    }
+
+    for (int i = 0; i < 6; ++i) {
+        block[2 + i] = (unsigned char)(indices >> (8 * i));
+    }
+}
+
+static uint16_t PackRGB565(const int color[3]) {
+    return (uint16_t)((((color[0] * 31 + 127) / 255) << 11) | (((color[1] * 63 + 127) / 255) << 5) | ((color[2] * 31 + 127) / 255));
+}
+
+static void UnpackRGB565(uint16_t packed, int color[3]) {
+    int red = packed >> 11;
+    int green = (packed >> 5) & 63;
+    int blue = packed & 31;
+    color[0] = (red << 3) | (red >> 2);
+    color[1] = (green << 2) | (green >> 4);
+    color[2] = (blue << 3) | (blue >> 2);
+}
+
+// The end points are the corners of the bounding box of the block colors, and
+// every texel picks the nearest of the four colors along the diagonal
+static void EncodeColorBlock(const unsigned char texels[64], unsigned char* block) {
+    unsigned char min_color[4];
+    unsigned char max_color[4];
+    MinMaxColors(texels, min_color, max_color);
+
+    // Insetting the box by a sixteenth of its size lowers the average error
+    int low[3];
+    int high[3];
+    for (int c = 0; c < 3; ++c) {
+        int inset = (max_color[c] - min_color[c]) >> 4;
+        low[c] = min_color[c] + inset;
+        high[c] = max_color[c] - inset;
+    }
+
+    // Each component of the maximum is at least the one of the minimum, so the first color
+    // never sorts below the second and the block stays in four color mode
+    uint16_t color0 = PackRGB565(high);
+    uint16_t color1 = PackRGB565(low);
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        static const uint32_t step_index[4] = {1, 3, 2, 0};
+
+        int end0[3];
+        int end1[3];
+        UnpackRGB565(color0, end0);
+        UnpackRGB565(color1, end1);
+
+        int axis[3] = {end0[0] - end1[0], end0[1] - end1[1], end0[2] - end1[2]};
+        int length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+        for (int i = 0; i < 16; ++i) {
+            const unsigned char* texel = texels + i * 4;
+            int projection = (texel[0] - end1[0]) * axis[0] + (texel[1] - end1[1]) * axis[1] + (texel[2] - end1[2]) * axis[2];
+            int step = projection <= 0 ? 0 : std::min(3, (projection * 3 + length / 2) / length);
+            indices |= step_index[step] << (2 * i);
+        }
+    }
+
+    block[0] = (unsigned char)color0;
+    block[1] = (unsigned char)(color0 >> 8);
+    block[2] = (unsigned char)color1;
+    block[3] = (unsigned char)(color1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        block[4 + i] = (unsigned char)(indices >> (8 * i));
+    }
+}
+
+static void EncodeBlockRows(GLenum internal_format, const unsigned char* pixels, int width, int height, int first_row, int last_row, unsigned char* blocks) {
+    int components = TextureEncoderComponents(internal_format);
+    size_t block_bytes = BlockBytes(internal_format);
+    int blocks_x = (width + 3) / 4;
+
+    unsigned char texels[16 * 4];
+    unsigned char values[2][16];
+
+    for (int block_y = first_row; block_y < last_row; ++block_y) {
+        for (int block_x = 0; block_x < blocks_x; ++block_x) {
+            for (int y = 0; y < 4; ++y) {
+                int row = std::min(block_y * 4 + y, height - 1);
+                for (int x = 0; x < 4; ++x) {
+                    int column = std::min(block_x * 4 + x, width - 1);
+                    memcpy(texels + (y * 4 + x) * components, pixels + ((size_t)row * width + column) * components, components);
+                }
+            }
+
+            unsigned char* block = blocks + ((size_t)block_y * blocks_x + block_x) * block_bytes;
+            switch (internal_format) {
+                case GL_COMPRESSED_RED_RGTC1:
+                    EncodeChannelBlock(texels, block);
+                    break;
+                case GL_COMPRESSED_RG_RGTC2:
+                    for (int i = 0; i < 16; ++i) {
+                        values[0][i] = texels[i * 2 + 0];
+                        values[1][i] = texels[i * 2 + 1];
+                    }
+                    EncodeChannelBlock(values[0], block);
+                    EncodeChannelBlock(values[1], block + 8);
+                    break;
+                case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                    EncodeColorBlock(texels, block);
+                    break;
+                case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                    for (int i = 0; i < 16; ++i) {
+                        values[0][i] = texels[i * 4 + 3];
+                    }
+                    EncodeChannelBlock(values[0], block);
+                    EncodeColorBlock(texels, block + 8);
+                    break;
+            }
+        }
+    }
+}
+
+void TextureEncoderEncode(GLenum internal_format, const unsigned char* pixels, int width, int height, unsigned char* blocks) {
+    int block_rows = (height + 3) / 4;
+    int thread_count = std::max(1, std::min(block_rows / MinBlockRowsPerThread, (int)std::thread::hardware_concurrency()));
+    int rows_per_thread = (block_rows + thread_count - 1) / thread_count;
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < thread_count; ++i) {
+        int first_row = i * rows_per_thread;
+        int last_row = std::min(block_rows, first_row + rows_per_thread);
+        if (first_row < last_row) {
+            threads.emplace_back(EncodeBlockRows, internal_format, pixels, width, height, first_row, last_row, blocks);
+        }
+    }
+
+    EncodeBlockRows(internal_format, pixels, width, height, 0, std::min(block_rows, rows_per_thread), blocks);
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <glad/gl.h>
+
+#include "glextensions.h"
+
+// Block compression of decoded images, into 4x4 texel blocks:
+// - GL_COMPRESSED_RED_RGTC1 (BC4) from a single channel, 8 bytes per block
+// - GL_COMPRESSED_RG_RGTC2 (BC5) from two channels, 16 bytes per block
+// - GL_COMPRESSED_RGB_S3TC_DXT1_EXT (BC1) from RGBA, 8 bytes per block, alpha is dropped
+// - GL_COMPRESSED_RGBA_S3TC_DXT5_EXT (BC3) from RGBA, 16 bytes per block
+
+bool TextureEncoderIsCompressed(GLenum internal_format);
+// Channels of the pixels expected by the encoder of a compressed format
+int TextureEncoderComponents(GLenum internal_format);
+size_t TextureEncoderBytes(GLenum internal_format, int width, int height);
+// Rows are encoded in the order they are given, texels past the right and bottom
+// edges repeat the last column and row. Large images are split between threads.
+void TextureEncoderEncode(GLenum internal_format, const unsigned char* pixels, int width, int height, unsigned char* blocks);
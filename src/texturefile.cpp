@@ -0,0 +1,243 @@
+#include "texturefile.h"
+
+#include "utils.h"
+#include "textureencoder.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char TextureFileMagic[4] = {'L', 'G', 'T', 'X'};
+static const uint32_t TextureFileVersion = 1;
+
+// Pixels start right after the header, at an offset aligned for any upload
+struct TextureFileHeader {
+    char Magic[4];
+    uint32_t Version;
+    uint64_t PathHash;
+    int64_t ModificationTime;
+    uint64_t Size;
+    int32_t Width;
+    int32_t Height;
+    int32_t Channels;
+    uint32_t InternalFormat;
+    uint32_t Format;
+    uint32_t Type;
+    // Mip levels following the base level, none are stored yet
+    uint32_t Levels;
+    uint8_t Padding[4];
+};
+
+static_assert(sizeof(TextureFileHeader) == 64, "Texture file pixels must stay aligned");
+
+struct TextureFileCache {
+    std::mutex Mutex;
+    std::string Directory;
+};
+
+static TextureFileCache& GetTextureFileCache() {
+    static TextureFileCache cache;
+    return cache;
+}
+
+static std::string TextureFileDirectory() {
+    TextureFileCache& cache = GetTextureFileCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+    return cache.Directory;
+}
+
+static std::string TextureFilePath(const std::string& directory, uint64_t path_hash) {
+    char filename[32];
+    snprintf(filename, sizeof(filename), "%016llx.tex", (unsigned long long)path_hash);
+    return directory + PATH_DELIMITER + filename;
+}
+
+static uint32_t BytesPerPixel(const TextureFileInfo& info) {
+    uint32_t components = info.Format == GL_RED ? 1 : info.Format == GL_RG ? 2 : info.Format == GL_RGB ? 3 : 4;
+    uint32_t component_bytes = info.Type == GL_UNSIGNED_SHORT ? 2 : info.Type == GL_FLOAT ? 4 : 1;
+    return components * component_bytes;
+}
+
+static uint64_t SourceHash(const TextureFileSource& source) {
+    uint64_t hash = HashFNV1a(source.CanonicalPath);
+    return source.IsCompressed ? HashFNV1a("compressed", hash) : hash;
+}
+
+size_t TextureFilePixelBytes(const TextureFileInfo& info) {
+    if (TextureEncoderIsCompressed(info.InternalFormat)) {
+        return TextureEncoderBytes(info.InternalFormat, info.Width, info.Height);
+    }
+    return (size_t)info.Width * info.Height * BytesPerPixel(info);
+}
+
+void TextureFileSetDirectory(const std::string& directory) {
+    TextureFileCache& cache = GetTextureFileCache();
+    std::lock_guard<std::mutex> lock(cache.Mutex);
+
+    cache.Directory.clear();
+    if (!directory.empty() && !CreateDirectories(directory)) {
+        fprintf(stderr, "Failed to create texture cache directory: %s\n", directory.c_str());
+        return;
+    }
+    cache.Directory = directory;
+}
+
+bool TextureFileIsEnabled() {
+    return !TextureFileDirectory().empty();
+}
+
+static void* MapFile(const std::string& path, size_t& size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER file_size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    CloseHandle(file);
+    if (!mapping) {
+        return nullptr;
+    }
+
+    // The view keeps the mapping alive
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    size = (size_t)file_size.QuadPart;
+    return view;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return nullptr;
+    }
+
+    struct stat status;
+    void* view = nullptr;
+    if (fstat(file, &status) == 0 && status.st_size > 0) {
+        view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        view = view == MAP_FAILED ? nullptr : view;
+        size = (size_t)status.st_size;
+    }
+    close(file);
+    return view;
+#endif
+}
+
+static void UnmapFile(void* view, size_t size) {
+#ifdef _WIN32
+    UnmapViewOfFile(view);
+#else
+    munmap(view, size);
+#endif
+}
+
+bool TextureFileOpen(const TextureFileSource& source, TextureFile& file) {
+    std::string directory = TextureFileDirectory();
+    if (directory.empty()) {
+        return false;
+    }
+
+    size_t size = 0;
+    void* view = MapFile(TextureFilePath(directory, SourceHash(source)), size);
+    if (!view) {
+        return false;
+    }
+
+    TextureFileHeader header;
+    bool is_valid = size >= sizeof(header);
+    if (is_valid) {
+        memcpy(&header, view, sizeof(header));
+
+        TextureFileInfo info;
+        info.Width = header.Width;
+        info.Height = header.Height;
+        info.Channels = header.Channels;
+        info.InternalFormat = header.InternalFormat;
+        info.Format = header.Format;
+        info.Type = header.Type;
+
+        // A stale file is replaced once the source is decoded again
+        is_valid = memcmp(header.Magic, TextureFileMagic, sizeof(header.Magic)) == 0 &&
+            header.Version == TextureFileVersion &&
+            header.PathHash == SourceHash(source) &&
+            header.ModificationTime == source.ModificationTime &&
+            header.Size == source.Size &&
+            header.Width > 0 && header.Height > 0 && header.Levels == 0 &&
+            size == sizeof(header) + TextureFilePixelBytes(info);
+
+        file.Info = info;
+    }
+
+    if (!is_valid) {
+        UnmapFile(view, size);
+        return false;
+    }
+
+    file.Mapping = view;
+    file.MappingSize = size;
+    file.Pixels = (const unsigned char*)view + sizeof(TextureFileHeader);
+    return true;
+}
+
+void TextureFileClose(TextureFile& file) {
+    if (file.Mapping) {
+        UnmapFile(file.Mapping, file.MappingSize);
+    }
+    file = TextureFile();
+}
+
+void TextureFileStore(const TextureFileSource& source, const TextureFileInfo& info, const unsigned char* pixels) {
+    std::string directory = TextureFileDirectory();
+    if (directory.empty()) {
+        return;
+    }
+
+    TextureFileHeader header = {};
+    memcpy(header.Magic, TextureFileMagic, sizeof(header.Magic));
+    header.Version = TextureFileVersion;
+    header.PathHash = SourceHash(source);
+    header.ModificationTime = source.ModificationTime;
+    header.Size = source.Size;
+    header.Width = info.Width;
+    header.Height = info.Height;
+    header.Channels = info.Channels;
+    header.InternalFormat = info.InternalFormat;
+    header.Format = info.Format;
+    header.Type = info.Type;
+
+    // Write to a temporary file first so that a concurrent reader never maps a partial file
+    std::string path = TextureFilePath(directory, header.PathHash);
+    std::string temporary_path = TemporaryFilePath(path);
+    FILE* file = fopen(temporary_path.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+
+    size_t pixel_bytes = TextureFilePixelBytes(info);
+    bool is_written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(pixels, 1, pixel_bytes, file) == pixel_bytes;
+    fclose(file);
+
+    if (!is_written) {
+        remove(temporary_path.c_str());
+        return;
+    }
+
+    // A mapping of the previous file stays valid once it is replaced, except on
+    // Windows where the replacement is skipped until the mapping is closed
+    if (!RenameFile(temporary_path, path)) {
+        remove(temporary_path.c_str());
+    }
+}
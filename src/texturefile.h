@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <glad/gl.h>
+
+struct TextureFileInfo {
+    int Width {0};
+    int Height {0};
+    // Channels of the source image
+    int Channels {0};
+    GLenum InternalFormat {GL_RGBA8};
+    GLenum Format {GL_RGBA};
+    GLenum Type {GL_UNSIGNED_BYTE};
+};
+
+// Identity of the image file a texture file was made from
+struct TextureFileSource {
+    std::string CanonicalPath;
+    int64_t ModificationTime {0};
+    uint64_t Size {0};
+    // Block compressed textures are stored apart from the uncompressed ones
+    bool IsCompressed {false};
+};
+
+// A texture file mapped in memory, Pixels point into the mapping
+struct TextureFile {
+    TextureFileInfo Info;
+    const unsigned char* Pixels {nullptr};
+    void* Mapping {nullptr};
+    size_t MappingSize {0};
+};
+
+// Decoded images are stored in a cache directory as pixels ready to upload, one
+// file per source image, replaced whenever the source changes. Later launches map
+// them instead of decoding the images again.
+void TextureFileSetDirectory(const std::string& directory);
+bool TextureFileIsEnabled();
+bool TextureFileOpen(const TextureFileSource& source, TextureFile& file);
+void TextureFileClose(TextureFile& file);
+void TextureFileStore(const TextureFileSource& source, const TextureFileInfo& info, const unsigned char* pixels);
+size_t TextureFilePixelBytes(const TextureFileInfo& info);
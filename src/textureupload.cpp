@@ -0,0 +1,185 @@
+#include "textureupload.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "glextensions.h"
+#include "textureencoder.h"
+
+static const int RingBufferCount = 4;
+static const int64_t RingBufferBytes = 4 * 1024 * 1024;
+// Only reached when waiting for the GPU to release a buffer
+static const GLuint64 FenceTimeout = 1000000000;
+
+struct RingBuffer {
+    GLuint Id {0};
+    // Persistent mapping, left empty when buffers are orphaned
+    unsigned char* Mapping {nullptr};
+    // Signaled once the GPU is done reading the buffer
+    GLsync Fence {nullptr};
+};
+
+struct UploadRing {
+    RingBuffer Buffers[RingBufferCount];
+    uint32_t Next {0};
+    bool IsCreated {false};
+    bool IsPersistent {false};
+    GLResourceStats Stats;
+};
+
+static UploadRing& GetUploadRing() {
+    static UploadRing ring;
+    return ring;
+}
+
+static void CreateRing(UploadRing& ring) {
+    ring.IsPersistent = GLExtensionsGet().BufferStorage;
+
+    for (RingBuffer& buffer : ring.Buffers) {
+        buffer.Id = GLResourceCreate(EGLResourceTypeBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.Id);
+
+        if (ring.IsPersistent) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, RingBufferBytes, nullptr, flags);
+            buffer.Mapping = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, RingBufferBytes, flags);
+        } else {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, RingBufferBytes, nullptr, GL_STREAM_DRAW);
+        }
+
+        GLResourceDescribe(EGLResourceTypeBuffer, buffer.Id, GLResourceBufferInfo("textures", "upload ring", RingBufferBytes));
+        ++ring.Stats.Count[EGLResourceTypeBuffer];
+        ring.Stats.Bytes[EGLResourceTypeBuffer] += RingBufferBytes;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    ring.IsCreated = true;
+}
+
+// Pixels are an offset in the bound pixel buffer, or client memory when none is bound
+static void UploadRows(const TextureUpload& upload, int rows, int64_t bytes, const void* pixels) {
+    if (TextureEncoderIsCompressed(upload.InternalFormat)) {
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.Rows, upload.Width, rows, upload.InternalFormat, (GLsizei)bytes, pixels);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.Rows, upload.Width, rows, upload.Format, upload.Type, pixels);
+    }
+}
+
+// Returns false when the buffer is still read by the GPU, pixels is left pointing
+// to the source when the buffer can not be mapped
+static bool WriteBuffer(UploadRing& ring, RingBuffer& buffer, const unsigned char* source, int64_t bytes, bool wait, const void*& pixels) {
+    pixels = source;
+
+    if (buffer.Fence) {
+        GLenum status = glClientWaitSync(buffer.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? FenceTimeout : 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return false;
+        }
+        glDeleteSync(buffer.Fence);
+        buffer.Fence = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.Id);
+
+    if (ring.IsPersistent) {
+        memcpy(buffer.Mapping, source, bytes);
+        pixels = nullptr;
+        return true;
+    }
+
+    // Orphaning lets the driver hand out fresh memory while the previous contents are still read
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, RingBufferBytes, nullptr, GL_STREAM_DRAW);
+    void* mapping = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!mapping) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return true;
+    }
+
+    memcpy(mapping, source, bytes);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    pixels = nullptr;
+    return true;
+}
+
+void TextureUploadBegin(TextureUpload& upload) {
+    glBindTexture(GL_TEXTURE_2D, upload.Id);
+    glTexImage2D(GL_TEXTURE_2D, 0, upload.InternalFormat, upload.Width, upload.Height, 0, upload.Format, upload.Type, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    upload.Rows = 0;
+}
+
+bool TextureUploadStream(TextureUpload& upload, int64_t& budget_bytes, bool wait) {
+    UploadRing& ring = GetUploadRing();
+    if (!ring.IsCreated) {
+        CreateRing(ring);
+    }
+
+    // Compressed textures are streamed in whole rows of blocks
+    int unit_rows = TextureEncoderIsCompressed(upload.InternalFormat) ? 4 : 1;
+    int64_t unit_bytes = GLResourceTextureBytes(upload.Width, unit_rows, upload.InternalFormat);
+
+    glBindTexture(GL_TEXTURE_2D, upload.Id);
+    // Rows of single channel and RGB images are not padded to four bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    while (upload.Rows < upload.Height && budget_bytes > 0) {
+        int64_t units = std::max<int64_t>(1, std::min(budget_bytes, RingBufferBytes) / unit_bytes);
+        int rows = (int)std::min<int64_t>(upload.Height - upload.Rows, units * unit_rows);
+        int64_t offset = GLResourceTextureBytes(upload.Width, upload.Rows, upload.InternalFormat);
+        int64_t bytes = GLResourceTextureBytes(upload.Width, rows, upload.InternalFormat);
+        const unsigned char* source = upload.Pixels + offset;
+
+        if (bytes > RingBufferBytes) {
+            // A single row larger than a buffer is copied from client memory
+            UploadRows(upload, rows, bytes, source);
+        } else {
+            RingBuffer& buffer = ring.Buffers[ring.Next];
+            const void* pixels = nullptr;
+            if (!WriteBuffer(ring, buffer, source, bytes, wait, pixels)) {
+                break;
+            }
+
+            UploadRows(upload, rows, bytes, pixels);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            // Orphaned buffers need no fence, the driver keeps their previous storage alive
+            if (ring.IsPersistent) {
+                buffer.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+            ring.Next = (ring.Next + 1) % RingBufferCount;
+        }
+
+        upload.Rows += rows;
+        budget_bytes -= bytes;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return upload.Rows >= upload.Height;
+}
+
+GLResourceStats TextureUploadResourceStats() {
+    return GetUploadRing().Stats;
+}
+
+void TextureUploadDestroy() {
+    UploadRing& ring = GetUploadRing();
+    if (!ring.IsCreated) {
+        return;
+    }
+
+    for (RingBuffer& buffer : ring.Buffers) {
+        if (buffer.Fence) {
+            glDeleteSync(buffer.Fence);
+        }
+        if (buffer.Mapping) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.Id);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        GLResourceDestroy(EGLResourceTypeBuffer, buffer.Id);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    ring = UploadRing();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <glad/gl.h>
+
+#include "glresource.h"
+
+// A texture whose pixels are streamed in chunks of rows, bottom row first
+struct TextureUpload {
+    GLuint Id {0};
+    GLenum InternalFormat {GL_RGBA8};
+    GLenum Format {GL_RGBA};
+    GLenum Type {GL_UNSIGNED_BYTE};
+    int Width {0};
+    int Height {0};
+    const unsigned char* Pixels {nullptr};
+    // Rows uploaded so far
+    int Rows {0};
+};
+
+// Pixels are copied to textures through a ring of pixel buffer objects, so that the
+// driver copies them asynchronously and a large image is spread over several frames
+// instead of stalling one. The buffers stay mapped where ARB_buffer_storage is
+// available, and are orphaned before each chunk otherwise. Render thread only.
+
+// Allocates the storage of the texture, rows not streamed yet are undefined so it
+// should not be sampled before the stream completes
+void TextureUploadBegin(TextureUpload& upload);
+// Streams chunks of rows until the budget runs out, it is decreased by the bytes
+// streamed. A chunk is streamed as long as some budget is left, even when it is
+// larger. Stops early when the next buffer of the ring is still read by the GPU,
+// unless wait is set. Returns true once every row is uploaded.
+bool TextureUploadStream(TextureUpload& upload, int64_t& budget_bytes, bool wait);
+// Buffers of the ring, which is created on the first upload
+GLResourceStats TextureUploadResourceStats();
+// Must be called while a context is current, before it is destroyed
+void TextureUploadDestroy();
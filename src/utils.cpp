@@ -1,6 +1,21 @@
 #include "utils.h"
 
+#include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
 
 std::vector<std::string> SplitString(const std::string& s, char delim) {
     std::vector<std::string> elems;
@@ -24,6 +39,18 @@ std::vector<std::string> SplitString(const std::string& s, char delim) {
     return elems;
 }
 
+bool NextLine(std::string_view& remaining, std::string_view& line, bool& has_line) {
+    if (!has_line) {
+        return false;
+    }
+
+    size_t line_end = remaining.find('\n');
+    has_line = line_end != std::string_view::npos;
+    line = remaining.substr(0, line_end);
+    remaining.remove_prefix(has_line ? line_end + 1 : remaining.size());
+    return true;
+}
+
 std::string ExtractBasePath(const std::string& path) {
     const char* cpath = path.c_str();
     const char* last_slash = strrchr(cpath, PATH_DELIMITER);
@@ -59,3 +86,100 @@ std::string ExtractFilenameWithoutExt(const std::string& path) {
 
     return filename;
 }
+
+uint64_t HashFNV1aBytes(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t HashFNV1a(const std::string& data, uint64_t hash) {
+    return HashFNV1aBytes(data.data(), data.size(), hash);
+}
+
+bool CreateDirectories(const std::string& path) {
+    if (path.empty()) {
+        return false;
+    }
+
+    for (size_t i = 1; i <= path.size(); ++i) {
+        if (i != path.size() && path[i] != '/' && path[i] != PATH_DELIMITER) {
+            continue;
+        }
+
+        std::string directory = path.substr(0, i);
+#ifdef _WIN32
+        int res = _mkdir(directory.c_str());
+#else
+        int res = mkdir(directory.c_str(), 0755);
+#endif
+        if (res != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string DefaultCacheDirectory() {
+#ifdef _WIN32
+    const char* local_app_data = getenv("LOCALAPPDATA");
+    if (local_app_data && *local_app_data) {
+        return std::string(local_app_data) + PATH_DELIMITER + "live-glsl";
+    }
+#else
+    const char* xdg_cache_home = getenv("XDG_CACHE_HOME");
+    if (xdg_cache_home && *xdg_cache_home) {
+        return std::string(xdg_cache_home) + PATH_DELIMITER + "live-glsl";
+    }
+
+    const char* home = getenv("HOME");
+    if (home && *home) {
+        return std::string(home) + PATH_DELIMITER + ".cache" + PATH_DELIMITER + "live-glsl";
+    }
+#endif
+    return "";
+}
+
+std::vector<std::string> ListShaderFiles(const std::string& directory) {
+    std::vector<std::string> paths;
+    std::error_code error;
+
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        std::string extension = it->path().extension().string();
+        if (it->is_regular_file() && (extension == ".frag" || extension == ".fs")) {
+            paths.push_back(it->path().string());
+        }
+    }
+
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+int64_t FileModificationTime(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return 0;
+    }
+    return (int64_t)st.st_mtime;
+}
+
+std::string TemporaryFilePath(const std::string& path) {
+    static std::atomic<uint64_t> counter {0};
+#ifdef _WIN32
+    int pid = _getpid();
+#else
+    int pid = (int)getpid();
+#endif
+    return path + "." + std::to_string(pid) + "." + std::to_string(counter++) + ".tmp";
+}
+
+bool RenameFile(const std::string& source, const std::string& destination) {
+#ifdef _WIN32
+    remove(destination.c_str());
+#endif
+    return rename(source.c_str(), destination.c_str()) == 0;
+}
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <vector>
+#include <string_view>
+#include <stdint.h>
 
 template <typename T, unsigned long N>
 char(&ArrayLength(T (&array)[N]))[N];
@@ -15,5 +17,19 @@ char(&ArrayLength(T (&array)[N]))[N];
 #endif
 
 std::vector<std::string> SplitString(const std::string& s, char delim);
+// Splits the next line off the remaining text, without its line feed
+bool NextLine(std::string_view& remaining, std::string_view& line, bool& has_line);
 std::string ExtractBasePath(const std::string& path);
 std::string ExtractFilenameWithoutExt(const std::string& path);
+uint64_t HashFNV1aBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+uint64_t HashFNV1a(const std::string& data, uint64_t hash = 14695981039346656037ull);
+bool CreateDirectories(const std::string& path);
+std::string DefaultCacheDirectory();
+// Shader files found under a directory, sorted so that runs over the same files are comparable
+std::vector<std::string> ListShaderFiles(const std::string& directory);
+int64_t FileModificationTime(const std::string& path);
+// A path next to the given one that no other process or thread writes to
+std::string TemporaryFilePath(const std::string& path);
+// Replaces the destination atomically, except on Windows where it is removed first
+// and the rename fails while the destination is open
+bool RenameFile(const std::string& source, const std::string& destination);
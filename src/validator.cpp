@@ -0,0 +1,165 @@
+#include "validator.h"
+
+#include "utils.h"
+#include "shaderparser.h"
+#include "renderpass.h"
+#include "glextensions.h"
+#include "programcache.h"
+#include "texturecache.h"
+
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static std::string EscapeJSON(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", c);
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+void ValidatorWriteReport(const std::vector<ValidatorResult>& results, FILE* file) {
+    uint32_t failed = 0;
+    for (const ValidatorResult& result : results) {
+        failed += result.Success ? 0 : 1;
+    }
+
+    fprintf(file, "{\n  \"total\": %u,\n  \"failed\": %u,\n  \"shaders\": [\n", (uint32_t)results.size(), failed);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ValidatorResult& result = results[i];
+        fprintf(file, "    {\"path\": \"%s\", \"success\": %s, \"passes\": %u, \"compile_ms\": %.3f",
+            EscapeJSON(result.Path).c_str(), result.Success ? "true" : "false", result.RenderPasses, result.CompileMS);
+        if (!result.Success) {
+            fprintf(file, ", \"error\": \"%s\"", EscapeJSON(result.Error).c_str());
+        }
+        fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+static void Validate(const std::string& path, ValidatorResult& result) {
+    std::vector<std::string> watches;
+    std::vector<RenderPass> render_passes;
+    std::vector<GUIComponent> components;
+
+    auto start = std::chrono::steady_clock::now();
+
+    result.Path = path;
+    result.Success =
+        ShaderParserParse(ExtractBasePath(path), path, watches, render_passes, components, result.Error) &&
+        RenderPassCreate(render_passes, result.Error);
+    glFinish();
+
+    result.CompileMS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.RenderPasses = (uint32_t)render_passes.size();
+
+    RenderPassDestroy(render_passes);
+}
+
+static void ValidateThread(GLFWwindow* window, int32_t compiler_threads, const std::vector<std::string>& paths, std::atomic<size_t>& next, std::vector<ValidatorResult>& results) {
+    glfwMakeContextCurrent(window);
+    GLExtensionsSetCompilerThreads(compiler_threads);
+
+    for (size_t i = next++; i < paths.size(); i = next++) {
+        Validate(paths[i], results[i]);
+        fprintf(stderr, "%s %s\n", results[i].Success ? "ok    " : "failed", paths[i].c_str());
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+int ValidatorRun(const Arguments& args) {
+    std::vector<std::string> paths = ListShaderFiles(args.ValidateDirectory);
+    if (paths.empty()) {
+        fprintf(stderr, "No shader found in %s\n", args.ValidateDirectory.c_str());
+        return EXIT_FAILURE;
+    }
+
+    glfwSetErrorCallback([](int error, const char* description) {
+        fprintf(stderr, "Error: %s\n", description);
+    });
+
+    if (!glfwInit()) {
+        return EXIT_FAILURE;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    // Windows can only be created from the main thread, each worker gets its own context up front.
+    // Contexts share their objects, textures are cached across shaders.
+    uint32_t thread_count = std::max(1u, std::min(std::thread::hardware_concurrency(), (uint32_t)paths.size()));
+    std::vector<GLFWwindow*> windows;
+    for (uint32_t i = 0; i < thread_count; ++i) {
+        GLFWwindow* window = glfwCreateWindow(1, 1, "live-glsl validator", NULL, windows.empty() ? NULL : windows[0]);
+        if (!window) {
+            break;
+        }
+        windows.push_back(window);
+    }
+
+    if (windows.empty()) {
+        glfwTerminate();
+        return EXIT_FAILURE;
+    }
+
+    glfwMakeContextCurrent(windows[0]);
+    gladLoadGL(glfwGetProcAddress);
+    GLExtensionsLoad(glfwGetProcAddress);
+    glfwMakeContextCurrent(nullptr);
+
+    if (args.EnableCache) {
+        std::string cache_directory = args.CacheDirectory.empty() ? DefaultCacheDirectory() : args.CacheDirectory;
+        ProgramCacheSetDirectory(cache_directory);
+        TextureFileSetDirectory(cache_directory + PATH_DELIMITER + "textures");
+    }
+
+    std::vector<ValidatorResult> results(paths.size());
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    for (GLFWwindow* window : windows) {
+        threads.emplace_back(ValidateThread, window, args.CompilerThreads, std::cref(paths), std::ref(next), std::ref(results));
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    glfwMakeContextCurrent(windows[0]);
+    TextureCacheClear();
+    glfwMakeContextCurrent(nullptr);
+
+    for (GLFWwindow* window : windows) {
+        glfwDestroyWindow(window);
+    }
+    glfwTerminate();
+
+    ValidatorWriteReport(results, stdout);
+
+    bool has_failure = std::any_of(results.begin(), results.end(), [](const ValidatorResult& result) {
+        return !result.Success;
+    });
+    return has_failure ? EXIT_FAILURE : EXIT_SUCCESS;
+}
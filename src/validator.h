@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "arguments.h"
+
+struct ValidatorResult {
+    std::string Path;
+    bool Success {false};
+    uint32_t RenderPasses {0};
+    double CompileMS {0.0};
+    std::string Error;
+};
+
+void ValidatorWriteReport(const std::vector<ValidatorResult>& results, FILE* file);
+// Parses and compiles every shader of the directory given with --validate, on hidden
+// windows driven by a pool of threads, and prints a JSON report to stdout.
+int ValidatorRun(const Arguments& args);
@@ -0,0 +1,73 @@
+#include "variantcache.h"
+
+#include <list>
+#include <unordered_map>
+
+struct VariantCacheEntry {
+    uint64_t Key;
+    ShaderProgram Program;
+};
+
+struct VariantCache {
+    uint32_t Capacity;
+    // Most recently used first
+    std::list<VariantCacheEntry> Entries;
+    std::unordered_map<uint64_t, std::list<VariantCacheEntry>::iterator> Lookup;
+};
+
+HVariantCache VariantCacheCreate(uint32_t capacity) {
+    VariantCache* cache = new VariantCache();
+    cache->Capacity = capacity > 0 ? capacity : 1;
+    return cache;
+}
+
+void VariantCacheDestroy(HVariantCache handle) {
+    VariantCache* cache = (VariantCache*)handle;
+    for (VariantCacheEntry& entry : cache->Entries) {
+        ShaderProgramDestroy(entry.Program);
+    }
+    delete cache;
+}
+
+bool VariantCacheFind(HVariantCache handle, uint64_t key, ShaderProgram& program) {
+    VariantCache* cache = (VariantCache*)handle;
+    auto it = cache->Lookup.find(key);
+    if (it == cache->Lookup.end()) {
+        return false;
+    }
+
+    cache->Entries.splice(cache->Entries.begin(), cache->Entries, it->second);
+    program = it->second->Program;
+    return true;
+}
+
+bool VariantCacheContains(HVariantCache handle, uint64_t key) {
+    VariantCache* cache = (VariantCache*)handle;
+    return cache->Lookup.count(key) > 0;
+}
+
+void VariantCacheInsert(HVariantCache handle, uint64_t key, const ShaderProgram& program) {
+    VariantCache* cache = (VariantCache*)handle;
+    auto it = cache->Lookup.find(key);
+    if (it != cache->Lookup.end()) {
+        ShaderProgramDestroy(it->second->Program);
+        it->second->Program = program;
+        cache->Entries.splice(cache->Entries.begin(), cache->Entries, it->second);
+        return;
+    }
+
+    if (cache->Entries.size() >= cache->Capacity) {
+        VariantCacheEntry& oldest = cache->Entries.back();
+        ShaderProgramDestroy(oldest.Program);
+        cache->Lookup.erase(oldest.Key);
+        cache->Entries.pop_back();
+    }
+
+    cache->Entries.push_front({key, program});
+    cache->Lookup[key] = cache->Entries.begin();
+}
+
+uint32_t VariantCacheSize(HVariantCache handle) {
+    VariantCache* cache = (VariantCache*)handle;
+    return (uint32_t)cache->Entries.size();
+}
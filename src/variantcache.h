@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "shader.h"
+
+typedef void* HVariantCache;
+
+// Keeps a bounded number of specialized programs, evicting the least recently
+// used one. The cache owns its programs: a program found in the cache is only
+// valid until the next insertion.
+HVariantCache VariantCacheCreate(uint32_t capacity);
+void VariantCacheDestroy(HVariantCache cache);
+bool VariantCacheFind(HVariantCache cache, uint64_t key, ShaderProgram& program);
+// Unlike a find, does not count as a use of the program
+bool VariantCacheContains(HVariantCache cache, uint64_t key);
+void VariantCacheInsert(HVariantCache cache, uint64_t key, const ShaderProgram& program);
+uint32_t VariantCacheSize(HVariantCache cache);
@@ -1,16 +1,31 @@
 #include "arguments.h"
 #include "utils.h"
 #include "filewatcher.h"
+#include "frameclock.h"
+#include "glresource.h"
+#include "profiler.h"
 #include "gui.h"
 #include "renderpass.h"
 #include "shaderparser.h"
+#include "variantcache.h"
+#include "validator.h"
+#include "playlist.h"
+#include "programcache.h"
+#include "includecache.h"
+#include "preprocessor.h"
+#include "texturecache.h"
+#include "textureencoder.h"
 #include "utest.h"
 
+#include <stb/stb_image_write.h>
+
 #include <string.h>
 #include <iostream>
 #include <fstream>
 #include <chrono>
 #include <thread>
+#include <filesystem>
+#include <algorithm>
 
 #define T(b) EXPECT_TRUE(b)
 #define TSTR(s0, s1) EXPECT_TRUE(0 == strcmp(s0,s1))
@@ -45,6 +60,64 @@ UTEST(arguments, parse_1) {
     T(!ArgumentsParse(ARRAY_LENGTH(args), args, arguments));
 }
 
+UTEST(arguments, parse_2) {
+    Arguments arguments;
+
+    const char* args[] = {
+        "liveglsl",
+        "--input",
+        "shader.frag",
+        "--fps",
+        "30",
+        "--unfocused-fps",
+        "2"
+    };
+
+    T(ArgumentsParse(ARRAY_LENGTH(args), args, arguments));
+    T(arguments.MaxFPS == 30);
+    T(arguments.UnfocusedFPS == 2);
+}
+
+UTEST(arguments, parse_cache) {
+    Arguments arguments;
+    T(arguments.EnableCache);
+    T(arguments.CacheDirectory.empty());
+    T(arguments.CompilerThreads == -1);
+
+    const char* args[] = {
+        "liveglsl",
+        "--input",
+        "shader.frag",
+        "--cache-dir",
+        "cache",
+        "--no-cache",
+        "--compiler-threads",
+        "4",
+        "--upload-budget",
+        "64"
+    };
+
+    T(arguments.UploadBudgetMB == 16);
+    T(ArgumentsParse(ARRAY_LENGTH(args), args, arguments));
+    T(arguments.CacheDirectory == "cache");
+    T(!arguments.EnableCache);
+    T(arguments.CompilerThreads == 4);
+    T(arguments.UploadBudgetMB == 64);
+}
+
+UTEST(arguments, parse_validate) {
+    const char* args[] = {
+        "liveglsl",
+        "--validate",
+        "shaders"
+    };
+
+    // The input is not needed when validating
+    Arguments arguments;
+    T(ArgumentsParse(ARRAY_LENGTH(args), args, arguments));
+    T(arguments.ValidateDirectory == "shaders");
+}
+
 void OnFileChanged(void* user_data, const char* file_path) {
     bool* callback_called = (bool*)user_data;
     *callback_called = true;
@@ -123,6 +196,110 @@ UTEST(filewatcher, add_watch_modify_2) {
     std::remove(file_path);
 }
 
+UTEST(frameclock, tick_wall_time) {
+    FrameClock clock;
+    FrameClockReset(clock, 10.0, 2.0);
+
+    FrameClockTick(clock, 10.5);
+    T(clock.Time == 2.0);
+    T(clock.DeltaTime == 0.0);
+
+    FrameClockTick(clock, 11.0);
+    T(clock.Time == 2.5);
+    T(clock.DeltaTime == 0.5);
+    T(clock.FrameIndex == 2);
+}
+
+UTEST(frameclock, tick_fixed_timestep) {
+    FrameClock clock;
+    clock.FixedTimestep = 0.25;
+    FrameClockReset(clock, 0.0, 0.0);
+
+    for (int i = 0; i < 5; ++i) {
+        FrameClockTick(clock, 100.0 * i);
+    }
+
+    T(clock.Time == 1.0);
+    T(clock.DeltaTime == 0.25);
+}
+
+UTEST(frameclock, pause_step_seek) {
+    FrameClock clock;
+    clock.FixedTimestep = 0.5;
+    FrameClockReset(clock, 0.0, 0.0);
+    FrameClockTick(clock, 0.0);
+
+    FrameClockSetPaused(clock, true);
+    T(!FrameClockIsAdvancing(clock));
+    FrameClockTick(clock, 1.0);
+    FrameClockTick(clock, 2.0);
+    T(clock.Time == 0.0);
+
+    FrameClockStep(clock);
+    T(FrameClockIsAdvancing(clock));
+    FrameClockTick(clock, 3.0);
+    T(clock.Time == 0.5);
+    FrameClockTick(clock, 4.0);
+    T(clock.Time == 0.5);
+
+    FrameClockSeek(clock, 12.0);
+    FrameClockTick(clock, 5.0);
+    T(clock.Time == 12.0);
+
+    FrameClockSetPaused(clock, false);
+    FrameClockTick(clock, 6.0);
+    T(clock.Time == 12.5);
+}
+
+UTEST(glresource, report_growth) {
+    GLResourceStats baseline;
+    baseline.Count[EGLResourceTypeProgram] = 2;
+    baseline.Count[EGLResourceTypeTexture] = 3;
+    baseline.Bytes[EGLResourceTypeTexture] = GLResourceTextureBytes(256, 256, GL_RGBA8);
+
+    std::string report;
+    T(!GLResourceReportGrowth(baseline, baseline, report));
+    T(report.empty());
+
+    GLResourceStats current = baseline;
+    current.Count[EGLResourceTypeProgram] = 3;
+    T(GLResourceReportGrowth(baseline, current, report));
+    TSTR(report.c_str(), "programs: 2 -> 3 (0 -> 0 bytes)\n");
+
+    GLResourceStats delta = GLResourceStatsSubtract(current, baseline);
+    T(delta.Count[EGLResourceTypeProgram] == 1);
+    T(delta.Count[EGLResourceTypeTexture] == 0);
+    T(delta.Bytes[EGLResourceTypeTexture] == 0);
+    T(GLResourceTextureBytes(256, 256, GL_R8) == 256 * 256);
+}
+
+UTEST(profiler, export_without_context) {
+    // Without a GL context timer queries are unsupported and nothing is recorded
+    HProfiler profiler = ProfilerCreate();
+    T(!ProfilerIsSupported(profiler));
+
+    ProfilerBeginFrame(profiler);
+    ProfilerBeginPass(profiler, "main", 800 * 600);
+    ProfilerEndPass(profiler);
+    ProfilerEndFrame(profiler);
+    T(ProfilerGetPassTimings(profiler).empty());
+
+    const char* file_path = "test_timings.csv";
+    T(ProfilerExport(profiler, file_path));
+
+    std::ifstream file(file_path);
+    std::string header, frame;
+    std::getline(file, header);
+    std::getline(file, frame);
+    file.close();
+
+    TSTR(header.c_str(), "pass,samples,average_ms,min_ms,max_ms,pixels,samples_passed,fragment_invocations");
+    TSTR(frame.c_str(), "frame,0,0,0,0,0,0,0");
+
+    ProfilerDestroy(profiler);
+    std::remove(file_path);
+}
+
 UTEST(gui, component_parse_invalid) {
     std::string line, uniform_line, error;
     GUIComponent component;
@@ -138,6 +315,44 @@ UTEST(gui, component_parse_invalid) {
     TSTR(error.c_str(), "Invalid GUI type name 'invalid_gui' at line 0");
 }
 
+UTEST(gui, component_parse_define) {
+    std::string line, uniform_line, error;
+    GUIComponent component;
+
+    line = "toggle";
+    uniform_line = "#define SOFT_SHADOWS";
+    T(GUIComponentParse(0, line, uniform_line, {}, component, error));
+    T(component.Type == EGUIComponentTypeToggle);
+    TSTR(component.UniformName.c_str(), "SOFT_SHADOWS");
+    T(component.Data[0] == 1.0f);
+
+    line = "choice(8, 32, 64)";
+    uniform_line = "#define STEPS 32";
+    T(GUIComponentParse(0, line, uniform_line, {}, component, error));
+    T(component.Type == EGUIComponentTypeChoice);
+    TSTR(component.UniformName.c_str(), "STEPS");
+    T(component.Choices.size() == 3);
+    T(component.Define.Default == 1);
+    T(component.Data[0] == 1.0f);
+
+    // A value missing from the choices is added to them
+    uniform_line = "#define STEPS 128";
+    T(GUIComponentParse(0, line, uniform_line, {}, component, error));
+    T(component.Choices.size() == 4);
+    TSTR(component.Choices[3].c_str(), "128");
+    T(component.Data[0] == 3.0f);
+
+    line = "toggle";
+    uniform_line = "uniform float v0;";
+    T(!GUIComponentParse(4, line, uniform_line, {}, component, error));
+    TSTR(error.c_str(), "@toggle is not associated with a #define at line 4");
+
+    line = "choice(8, 32)";
+    uniform_line = "#define STEPS";
+    T(!GUIComponentParse(4, line, uniform_line, {}, component, error));
+    TSTR(error.c_str(), "@choice is associated with a #define without value at line 4");
+}
+
 UTEST(gui, component_parse_slider_1) {
     std::string line, uniform_line, error;
     GUIComponent component;
@@ -276,7 +491,8 @@ UTEST(shader_parser, parse_0) {
     T(!render_passes[0].Textures.empty());
     T(render_passes[0].Textures[0].Width == 1653);
     T(render_passes[0].Textures[0].Height == 1252)
-    T(render_passes[0].Textures[0].Data);
+    T(TextureCacheWait(*render_passes[0].Textures[0].Image));
+    T(render_passes[0].Textures[0].Image->Data);
 
     T(!render_passes[1].IsMain);
     T(render_passes[1].Input == "pass0");
@@ -293,7 +509,735 @@ UTEST(shader_parser, parse_0) {
     T(!render_passes[2].Textures.empty());
     T(render_passes[2].Textures[0].Width == 2320);
     T(render_passes[2].Textures[0].Height == 1485)
-    T(render_passes[2].Textures[0].Data);
+    T(TextureCacheWait(*render_passes[2].Textures[0].Image));
+    T(render_passes[2].Textures[0].Image->Data);
+    T(render_passes[2].Textures[0].Path == "heightmap_1.png");
+
+    // heightmap_1.png has no alpha and keeps its three channels
+    int64_t expected_bytes = (256 * 256 + 512 * 512 + 1653 * 1252) * 4 + 2320 * 1485 * 3;
+    T(RenderPassRequiredBytes(render_passes) == expected_bytes);
+}
+
+UTEST(texture_cache, reuse_decoded) {
+    T(CreateDirectories("live_glsl_test_texture_cache"));
+    std::filesystem::copy_file("tests/heightmap_0.png", "live_glsl_test_texture_cache/heightmap.png", std::filesystem::copy_options::overwrite_existing);
+    {
+        std::ofstream shader("live_glsl_test_texture_cache/shader.frag");
+        shader << "@path(heightmap.png)" << std::endl << "uniform sampler2D heightmap;" << std::endl << "void main() {}" << std::endl;
+    }
+
+    // Recently modified files are always read again
+    auto past = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+    std::filesystem::last_write_time("live_glsl_test_texture_cache/heightmap.png", past);
+
+    TextureCacheClear();
+
+    std::vector<std::string> watches;
+    std::vector<RenderPass> render_passes[2];
+    std::vector<GUIComponent> components;
+    std::string error;
+    for (int i = 0; i < 2; ++i) {
+        T(ShaderParserParse("live_glsl_test_texture_cache", "live_glsl_test_texture_cache/shader.frag", watches, render_passes[i], components, error));
+    }
+
+    T(render_passes[0][0].Textures[0].Image == render_passes[1][0].Textures[0].Image);
+    T(render_passes[1][0].Textures[0].Width == 1653);
+    T(TextureCacheWait(*render_passes[1][0].Textures[0].Image));
+    T(render_passes[1][0].Textures[0].Image->Data);
+
+    TextureCacheStats stats = TextureCacheGetStats();
+    T(stats.Textures == 1);
+    T(stats.Decodes == 1);
+    T(stats.Hits == 1);
+    T(stats.Bytes == 1653 * 1252 * 4);
+
+    // Images used by a pass are not evicted
+    TextureCacheSetBudget(0);
+    T(TextureCacheGetStats().Textures == 1);
+
+    render_passes[0].clear();
+    render_passes[1].clear();
+    TextureCacheSetBudget(0);
+    T(TextureCacheGetStats().Textures == 0);
+    T(TextureCacheGetStats().Bytes == 0);
+    TextureCacheSetBudget(256 * 1024 * 1024);
+
+    // The header is read with the shader, the pixels in the background
+    {
+        std::ifstream source("tests/heightmap_0.png", std::ios::binary);
+        std::vector<char> header(4096);
+        source.read(header.data(), header.size());
+        std::ofstream truncated("live_glsl_test_texture_cache/heightmap.png", std::ios::binary | std::ios::trunc);
+        truncated.write(header.data(), header.size());
+    }
+
+    T(ShaderParserParse("live_glsl_test_texture_cache", "live_glsl_test_texture_cache/shader.frag", watches, render_passes[0], components, error));
+    T(render_passes[0][0].Textures[0].Height == 1252);
+    T(!TextureCacheWait(*render_passes[0][0].Textures[0].Image));
+    T(!render_passes[0][0].Textures[0].Image->Data);
+    render_passes[0].clear();
+
+    {
+        std::ofstream broken("live_glsl_test_texture_cache/heightmap.png", std::ios::trunc);
+        broken << "not an image";
+    }
+    T(!ShaderParserParse("live_glsl_test_texture_cache", "live_glsl_test_texture_cache/shader.frag", watches, render_passes[0], components, error));
+    TSTR(error.c_str(), "Failed to load texture at path heightmap.png at line 1");
+
+    remove("live_glsl_test_texture_cache/heightmap.png");
+    remove("live_glsl_test_texture_cache/shader.frag");
+    remove("live_glsl_test_texture_cache");
+}
+
+UTEST(texture_file, map_stored) {
+    T(CreateDirectories("live_glsl_test_texture_file"));
+    std::filesystem::copy_file("tests/heightmap_0.png", "live_glsl_test_texture_file/heightmap.png", std::filesystem::copy_options::overwrite_existing);
+    {
+        std::ofstream shader("live_glsl_test_texture_file/shader.frag");
+        shader << "@path(heightmap.png)" << std::endl << "uniform sampler2D heightmap;" << std::endl << "void main() {}" << std::endl;
+    }
+
+    // Recently modified files are not stored
+    auto past = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+    std::filesystem::last_write_time("live_glsl_test_texture_file/heightmap.png", past);
+
+    TextureFileSetDirectory("live_glsl_test_texture_file/cache");
+    TextureCacheClear();
+
+    std::vector<std::string> watches;
+    std::vector<RenderPass> render_passes;
+    std::vector<GUIComponent> components;
+    std::string error;
+    T(ShaderParserParse("live_glsl_test_texture_file", "live_glsl_test_texture_file/shader.frag", watches, render_passes, components, error));
+    T(TextureCacheWait(*render_passes[0].Textures[0].Image));
+    T(TextureCacheGetStats().Decodes == 1);
+
+    size_t bytes = 1653 * 1252 * 4;
+    std::vector<unsigned char> decoded(render_passes[0].Textures[0].Image->Data, render_passes[0].Textures[0].Image->Data + bytes);
+
+    render_passes.clear();
+    TextureCacheClear();
+
+    T(ShaderParserParse("live_glsl_test_texture_file", "live_glsl_test_texture_file/shader.frag", watches, render_passes, components, error));
+    const TextureImage& image = *render_passes[0].Textures[0].Image;
+    T(image.State == ETextureImageStateDecoded);
+    T(image.File.Mapping != nullptr);
+    T(image.Width == 1653 && image.Height == 1252 && image.Channels == 4);
+    T(memcmp(image.Data, decoded.data(), bytes) == 0);
+    T(TextureCacheGetStats().Mapped == 1);
+    T(TextureCacheGetStats().Decodes == 0);
+
+    // A changed source is decoded again
+    render_passes.clear();
+    TextureCacheClear();
+    std::filesystem::last_write_time("live_glsl_test_texture_file/heightmap.png", past - std::chrono::hours(1));
+    T(ShaderParserParse("live_glsl_test_texture_file", "live_glsl_test_texture_file/shader.frag", watches, render_passes, components, error));
+    T(TextureCacheWait(*render_passes[0].Textures[0].Image));
+    T(TextureCacheGetStats().Decodes == 1);
+
+    render_passes.clear();
+    TextureCacheClear();
+    TextureFileSetDirectory("");
+    std::filesystem::remove_all("live_glsl_test_texture_file");
+}
+
+UTEST(texture_cache, native_channels) {
+    T(CreateDirectories("live_glsl_test_native_channels"));
+
+    // Rows of both images are not a multiple of four bytes
+    const int width = 7;
+    const int height = 3;
+    unsigned char gray[width * height];
+    unsigned char rgb[width * height * 3];
+    for (int i = 0; i < width * height; ++i) {
+        gray[i] = (unsigned char)(i * 10);
+        rgb[i * 3 + 0] = (unsigned char)i;
+        rgb[i * 3 + 1] = (unsigned char)(i + 100);
+        rgb[i * 3 + 2] = (unsigned char)(i + 200);
+    }
+    T(stbi_write_png("live_glsl_test_native_channels/gray.png", width, height, 1, gray, width) != 0);
+    T(stbi_write_png("live_glsl_test_native_channels/rgb.png", width, height, 3, rgb, width * 3) != 0);
+
+    // Without a context swizzles are not supported and a single channel is spread over the color
+    std::shared_ptr<TextureImage> image;
+    T(TextureCacheLoad("live_glsl_test_native_channels/gray.png", false, image));
+    T(TextureCacheWait(*image));
+    T(image->Channels == 1 && image->InternalFormat == GL_RGBA8 && image->Format == GL_RGBA);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const unsigned char* texel = image->Data + (y * width + x) * 4;
+            unsigned char value = gray[(height - 1 - y) * width + x];
+            T(texel[0] == value && texel[1] == value && texel[2] == value && texel[3] == 255);
+        }
+    }
+
+    T(TextureCacheLoad("live_glsl_test_native_channels/rgb.png", false, image));
+    T(TextureCacheWait(*image));
+    T(image->Channels == 3 && image->InternalFormat == GL_RGB8 && image->Format == GL_RGB && image->Type == GL_UNSIGNED_BYTE);
+    for (int y = 0; y < height; ++y) {
+        T(memcmp(image->Data + y * width * 3, rgb + (height - 1 - y) * width * 3, width * 3) == 0);
+    }
+
+    image.reset();
+    TextureCacheClear();
+    std::filesystem::remove_all("live_glsl_test_native_channels");
+}
+
+static void DecodeChannelBlock(const unsigned char* block, unsigned char values[16]) {
+    int palette[8] = {block[0], block[1]};
+    for (int i = 2; i < 8; ++i) {
+        if (block[0] > block[1]) {
+            palette[i] = ((8 - i) * block[0] + (i - 1) * block[1]) / 7;
+        } else {
+            palette[i] = i == 6 ? 0 : i == 7 ? 255 : ((6 - i) * block[0] + (i - 1) * block[1]) / 5;
+        }
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; ++i) {
+        indices |= (uint64_t)block[2 + i] << (8 * i);
+    }
+    for (int i = 0; i < 16; ++i) {
+        values[i] = (unsigned char)palette[(indices >> (3 * i)) & 7];
+    }
+}
+
+UTEST(texture_encoder, encode_blocks) {
+    T(TextureEncoderIsCompressed(GL_COMPRESSED_RED_RGTC1));
+    T(!TextureEncoderIsCompressed(GL_RGBA8));
+
+    // Partial blocks at the edges take whole blocks
+    T(TextureEncoderBytes(GL_COMPRESSED_RED_RGTC1, 5, 4) == 16);
+    T(TextureEncoderBytes(GL_COMPRESSED_RG_RGTC2, 5, 4) == 32);
+    T(TextureEncoderBytes(GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 8, 9) == 48);
+    T(TextureEncoderBytes(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 1, 1) == 16);
+
+    // A gradient is kept within half a step of the eight values between its extremes,
+    // the image is large enough to be split between threads
+    const int size = 256;
+    std::vector<unsigned char> gradient(size * size);
+    for (int i = 0; i < size * size; ++i) {
+        gradient[i] = (unsigned char)((i % 64) * 4 + (i / size) % 4);
+    }
+    std::vector<unsigned char> blocks(TextureEncoderBytes(GL_COMPRESSED_RED_RGTC1, size, size));
+    TextureEncoderEncode(GL_COMPRESSED_RED_RGTC1, gradient.data(), size, size, blocks.data());
+    for (int block = 0; block < (size / 4) * (size / 4); ++block) {
+        unsigned char values[16];
+        DecodeChannelBlock(blocks.data() + block * 8, values);
+        for (int i = 0; i < 16; ++i) {
+            int x = (block % (size / 4)) * 4 + i % 4;
+            int y = (block / (size / 4)) * 4 + i / 4;
+            T(abs(values[i] - gradient[y * size + x]) <= 2);
+        }
+    }
+
+    // A single color needs no indices, texels past the edges repeat the last ones
+    unsigned char red[6 * 5 * 4];
+    for (int i = 0; i < 6 * 5; ++i) {
+        red[i * 4 + 0] = 255;
+        red[i * 4 + 1] = 0;
+        red[i * 4 + 2] = 0;
+        red[i * 4 + 3] = 128;
+    }
+    blocks.assign(TextureEncoderBytes(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 6, 5), 0xFF);
+    TextureEncoderEncode(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, red, 6, 5, blocks.data());
+    for (int block = 0; block < 4; ++block) {
+        const unsigned char* encoded = blocks.data() + block * 16;
+        unsigned char alpha[16];
+        DecodeChannelBlock(encoded, alpha);
+        T(std::all_of(alpha, alpha + 16, [](unsigned char value) { return value == 128; }));
+
+        const unsigned char expected_color[8] = {0x00, 0xF8, 0x00, 0xF8, 0, 0, 0, 0};
+        T(memcmp(encoded + 8, expected_color, 8) == 0);
+    }
+
+    // Without a context no compressed format is supported, the image is loaded as it is
+    T(CreateDirectories("live_glsl_test_texture_encoder"));
+    std::filesystem::copy_file("tests/heightmap_1.png", "live_glsl_test_texture_encoder/heightmap.png", std::filesystem::copy_options::overwrite_existing);
+    {
+        std::ofstream shader("live_glsl_test_texture_encoder/shader.frag");
+        shader << "@path(heightmap.png, compress)" << std::endl << "uniform sampler2D heightmap;" << std::endl << "void main() {}" << std::endl;
+    }
+
+    std::vector<std::string> watches;
+    std::vector<RenderPass> render_passes;
+    std::vector<GUIComponent> components;
+    std::string error;
+    T(ShaderParserParse("live_glsl_test_texture_encoder", "live_glsl_test_texture_encoder/shader.frag", watches, render_passes, components, error));
+    T(render_passes[0].Textures[0].Path == "heightmap.png");
+    T(render_passes[0].Textures[0].Image->IsCompressed);
+    T(render_passes[0].Textures[0].Image->InternalFormat == GL_RGB8);
+    T(TextureCacheWait(*render_passes[0].Textures[0].Image));
+    render_passes.clear();
+
+    {
+        std::ofstream shader("live_glsl_test_texture_encoder/shader.frag", std::ios::trunc);
+        shader << "@path(heightmap.png, mipmaps)" << std::endl << "uniform sampler2D heightmap;" << std::endl << "void main() {}" << std::endl;
+    }
+    T(!ShaderParserParse("live_glsl_test_texture_encoder", "live_glsl_test_texture_encoder/shader.frag", watches, render_passes, components, error));
+    TSTR(error.c_str(), "Unknown @path option mipmaps, expected @path(path, compress) at line 1");
+
+    TextureCacheClear();
+    std::filesystem::remove_all("live_glsl_test_texture_encoder");
+}
+
+UTEST(shader_parser, parse_throughput) {
+    // Four passes including the same 1.2MB library
+    T(CreateDirectories("live_glsl_test_throughput"));
+    {
+        std::ofstream library("live_glsl_test_throughput/library.glsl");
+        for (int i = 0; i < 20000; ++i) {
+            library << "float function_" << i << "(float x) { return x * " << i << ".0 + sin(x); }" << std::endl;
+        }
+
+        std::ofstream shader("live_glsl_test_throughput/shader.frag");
+        for (int i = 0; i < 4; ++i) {
+            shader << "@pass(pass" << i << ", 64, 64)" << std::endl;
+            shader << "#include \"library.glsl\"" << std::endl;
+            shader << "@slider1(0, 1)" << std::endl;
+            shader << "uniform float value" << i << ";" << std::endl;
+            shader << "void main() {}" << std::endl;
+            shader << "@pass_end" << std::endl;
+        }
+    }
+
+    std::vector<std::string> watches;
+    std::vector<RenderPass> render_passes;
+    std::vector<GUIComponent> components;
+    std::string error;
+
+    auto start = std::chrono::steady_clock::now();
+    T(ShaderParserParse("live_glsl_test_throughput", "live_glsl_test_throughput/shader.frag", watches, render_passes, components, error));
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t bytes = 0;
+    for (const RenderPass& render_pass : render_passes) {
+        bytes += render_pass.ShaderSource.size();
+    }
+    printf("Parsed %.1fMB in %.1fms (%.1fMB/s)\n", bytes / 1e6, elapsed_ms, bytes / 1e3 / elapsed_ms);
+
+    T(render_passes.size() == 4);
+    T(components.size() == 4);
+    T(watches.size() == 5);
+    T(render_passes[3].Output == "pass3");
+    T(render_passes[3].ShaderSource.find("function_19999") != std::string::npos);
+
+    remove("live_glsl_test_throughput/library.glsl");
+    remove("live_glsl_test_throughput/shader.frag");
+    remove("live_glsl_test_throughput");
+}
+
+UTEST(shader_parser, include_once) {
+    T(CreateDirectories("live_glsl_test_include"));
+    {
+        std::ofstream once("live_glsl_test_include/once.glsl");
+        once << "#pragma once" << std::endl << "float once() { return 1.0; }" << std::endl;
+        std::ofstream guarded("live_glsl_test_include/guarded.glsl");
+        guarded << "// guarded" << std::endl << "#ifndef GUARDED" << std::endl << "#define GUARDED" << std::endl;
+        guarded << "#ifdef NESTED" << std::endl << "#endif" << std::endl << "float guarded() { return 2.0; }" << std::endl << "#endif" << std::endl;
+        std::ofstream unguarded("live_glsl_test_include/unguarded.glsl");
+        unguarded << "#ifndef UNGUARDED" << std::endl << "#define UNGUARDED" << std::endl << "#endif" << std::endl << "float unguarded;" << std::endl;
+        std::ofstream shader("live_glsl_test_include/shader.frag");
+        for (int i = 0; i < 2; ++i) {
+            shader << "#include \"once.glsl\"" << std::endl;
+            shader << "#include \"guarded.glsl\"" << std::endl;
+            shader << "#include \"unguarded.glsl\"" << std::endl;
+        }
+        shader << "void main() {}" << std::endl;
+    }
+
+    std::vector<std::string> watches;
+    std::vector<RenderPass> render_passes;
+    std::vector<GUIComponent> components;
+    std::string error;
+    T(ShaderParserParse("live_glsl_test_include", "live_glsl_test_include/shader.frag", watches, render_passes, components, error));
+
+    auto count = [](const std::string& source, const std::string& text) {
+        uint32_t found = 0;
+        for (size_t i = source.find(text); i != std::string::npos; i = source.find(text, i + 1)) {
+            ++found;
+        }
+        return found;
+    };
+
+    const std::string& source = render_passes[0].ShaderSource;
+    T(count(source, "float once()") == 1);
+    T(count(source, "float guarded()") == 1);
+    T(count(source, "float unguarded;") == 2);
+    T(count(source, "#pragma once") == 0);
+    T(watches.size() == 5);
+
+    // Each pass is compiled on its own and gets its own copy
+    {
+        std::ofstream shader("live_glsl_test_include/shader.frag", std::ios::trunc);
+        for (const char* pass : {"@pass(pass0, 64, 64)", "@pass(main, pass0)"}) {
+            shader << pass << std::endl;
+            shader << "#include \"once.glsl\"" << std::endl;
+            shader << "#include \"guarded.glsl\"" << std::endl;
+            shader << "void main() {}" << std::endl << "@pass_end" << std::endl;
+        }
+    }
+
+    watches.clear();
+    render_passes.clear();
+    T(ShaderParserParse("live_glsl_test_include", "live_glsl_test_include/shader.frag", watches, render_passes, components, error));
+    T(render_passes.size() == 2);
+    for (const RenderPass& render_pass : render_passes) {
+        T(count(render_pass.ShaderSource, "float once()") == 1);
+        T(count(render_pass.ShaderSource, "float guarded()") == 1);
+    }
+
+    for (const char* path : {"once.glsl", "guarded.glsl", "unguarded.glsl", "shader.frag"}) {
+        remove((std::string("live_glsl_test_include/") + path).c_str());
+    }
+    remove("live_glsl_test_include");
+}
+
+UTEST(shader_parser, include_cache) {
+    T(CreateDirectories("live_glsl_test_include_cache"));
+    {
+        std::ofstream library("live_glsl_test_include_cache/library.glsl");
+        library << "float library() { return 1.0; }" << std::endl;
+        std::ofstream shader("live_glsl_test_include_cache/shader.frag");
+        shader << "#include \"library.glsl\"" << std::endl << "void main() {}" << std::endl;
+    }
+
+    // Recently modified files are always read again
+    auto past = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+    std::filesystem::last_write_time("live_glsl_test_include_cache/library.glsl", past);
+    std::filesystem::last_write_time("live_glsl_test_include_cache/shader.frag", past);
+
+    IncludeCacheClear();
+
+    std::vector<std::string> watches;
+    std::vector<RenderPass> render_passes;
+    std::vector<GUIComponent> components;
+    std::string error;
+    for (int i = 0; i < 2; ++i) {
+        render_passes.clear();
+        T(ShaderParserParse("live_glsl_test_include_cache", "live_glsl_test_include_cache/shader.frag", watches, render_passes, components, error));
+    }
+
+    IncludeCacheStats stats = IncludeCacheGetStats();
+    T(stats.Files == 2);
+    T(stats.Reads == 2);
+    T(stats.Hits == 2);
+
+    {
+        std::ofstream library("live_glsl_test_include_cache/library.glsl");
+        library << "float library() { return 2.0; }" << std::endl;
+    }
+
+    render_passes.clear();
+    T(ShaderParserParse("live_glsl_test_include_cache", "live_glsl_test_include_cache/shader.frag", watches, render_passes, components, error));
+    T(render_passes[0].ShaderSource.find("return 2.0;") != std::string::npos);
+    T(IncludeCacheGetStats().Reads == 3);
+
+    remove("live_glsl_test_include_cache/library.glsl");
+    remove("live_glsl_test_include_cache/shader.frag");
+    remove("live_glsl_test_include_cache");
+}
+
+UTEST(shader_parser, inactive_branches) {
+    T(CreateDirectories("live_glsl_test_branches"));
+    {
+        std::ofstream shader("live_glsl_test_branches/shader.frag");
+        shader << "#define QUALITY 2" << std::endl;
+        shader << "#ifdef USE_GUI" << std::endl;
+        shader << "#include \"missing.glsl\"" << std::endl;
+        shader << "@slider1(0.0, 1.0)" << std::endl << "uniform float speed;" << std::endl;
+        shader << "@path(missing.png)" << std::endl << "uniform sampler2D noise;" << std::endl;
+        shader << "#elif QUALITY > 1 && defined(QUALITY)" << std::endl << "float high;" << std::endl;
+        shader << "#else" << std::endl << "float low;" << std::endl;
+        shader << "#endif" << std::endl;
+        shader << "#if GL_ES" << std::endl << "float es;" << std::endl << "#endif" << std::endl;
+        shader << "void main() {}" << std::endl;
+    }
+
+    std::vector<std::string> watches;
+    std::vector<RenderPass> render_passes;
+    std::vector<GUIComponent> components;
+    std::string error;
+    T(ShaderParserParse("live_glsl_test_branches", "live_glsl_test_branches/shader.frag", watches, render_passes, components, error));
+    T(components.empty());
+    T(watches.size() == 1);
+    T(render_passes[0].Textures.empty());
+
+    const std::string& source = render_passes[0].ShaderSource;
+    T(source.find("float high;") != std::string::npos);
+    T(source.find("float low;") == std::string::npos);
+    T(source.find("#ifdef") == std::string::npos);
+    T(source.find("#define QUALITY 2") != std::string::npos);
+    // Driver defined macros are left to the compiler
+    T(source.find("#if GL_ES") != std::string::npos);
+
+    // A conditional left open would silently drop the rest of the file
+    {
+        std::ofstream shader("live_glsl_test_branches/shader.frag", std::ios::trunc);
+        shader << "@pass(pass0, 64, 64)" << std::endl << "#ifdef FOO" << std::endl;
+        shader << "void main() {}" << std::endl << "@pass_end" << std::endl;
+    }
+    render_passes.clear();
+    T(!ShaderParserParse("live_glsl_test_branches", "live_glsl_test_branches/shader.frag", watches, render_passes, components, error));
+    T(error.find("Unterminated conditional") != std::string::npos);
+
+    {
+        std::ofstream shader("live_glsl_test_branches/shader.frag", std::ios::trunc);
+        shader << "#if 0" << std::endl << "void main() {}" << std::endl;
+    }
+    error.clear();
+    T(!ShaderParserParse("live_glsl_test_branches", "live_glsl_test_branches/shader.frag", watches, render_passes, components, error));
+    T(error.find("Unterminated conditional") != std::string::npos);
+
+    remove("live_glsl_test_branches/shader.frag");
+    remove("live_glsl_test_branches");
+}
+
+UTEST(preprocessor, process) {
+    auto run = [](const std::vector<std::string>& lines) {
+        Preprocessor preprocessor;
+        std::string output;
+        std::string replacement;
+        for (const std::string& line : lines) {
+            if (PreprocessorProcess(preprocessor, line, replacement)) {
+                output += (replacement.empty() ? line : replacement) + "\n";
+            }
+        }
+        return output;
+    };
+
+    TSTR(run({"#define A 0x10", "#if (A >> 2) == 4 && !defined B", "yes", "#else", "no", "#endif"}).c_str(), "#define A 0x10\nyes\n");
+    TSTR(run({"#if 1.0", "a", "#elif 1", "b", "#endif"}).c_str(), "#if 1.0\na\n#elif 1\nb\n#endif\n");
+    TSTR(run({"#if 0", "a", "#elif UNDEFINED_VALUE", "b", "#else", "c", "#endif"}).c_str(), "#if UNDEFINED_VALUE\nb\n#else\nc\n#endif\n");
+    TSTR(run({"#if 0", "#if 1", "a", "#endif", "#else", "b", "#endif"}).c_str(), "b\n");
+
+    // Defines driven by the GUI keep both branches
+    TSTR(run({"@toggle", "#define SOFT", "#ifdef SOFT", "a", "#endif", "#ifdef HARD", "b", "#endif"}).c_str(), "@toggle\n#define SOFT\n#ifdef SOFT\na\n#endif\n");
+
+    // Definitions do not carry over to the next render pass
+    TSTR(run({"#define A", "@pass_end", "#ifdef A", "a", "#endif"}).c_str(), "#define A\n@pass_end\n");
+
+    // Directives in block comments are ignored, comments are not part of expressions
+    TSTR(run({"/* usage:", "#ifdef FOO", "#define BAR", "*/", "#ifdef BAR", "a", "#endif", "b"}).c_str(), "/* usage:\n#ifdef FOO\n#define BAR\n*/\nb\n");
+    TSTR(run({"#define A 1 /* one */", "#if A /* && 0 */", "a", "#endif"}).c_str(), "#define A 1 /* one */\na\n");
+}
+
+UTEST(shader_parser, strip_unused) {
+    const char* source =
+        "layout(location = 0) out vec4 color;\n"
+        "uniform float speed;\n"
+        "const float PI = 3.14159;\n"
+        "const float TAU = 2.0 * PI;\n"
+        "const float UNUSED_A = 1.0, UNUSED_B = 2.0;\n"
+        "struct Ray { vec3 origin; };\n"
+        "// Not called\n"
+        "float unused(float x) {\n"
+        "    return x * TAU;\n"
+        "}\n"
+        "float helper(float x);\n"
+        "float macro_only() { return 1.0; }\n"
+        "#define CALL_MACRO() macro_only()\n"
+        "#ifdef SOFT\n"
+        "float soft() { return 0.5; }\n"
+        "#endif\n"
+        "float wave(float x) { return sin(x * PI); }\n"
+        "float helper(float x) { return wave(x) * speed; }\n"
+        "void main() {\n"
+        "    color = vec4(helper(1.0) + CALL_MACRO());\n"
+        "}\n";
+
+    std::string stripped;
+    T(ShaderParserStripUnused(source, stripped));
+
+    T(stripped.find("float unused") == std::string::npos);
+    T(stripped.find("Not called") == std::string::npos);
+    T(stripped.find("TAU") == std::string::npos);
+    T(stripped.find("float soft") == std::string::npos);
+    T(stripped.find("#ifdef SOFT") != std::string::npos);
+    T(stripped.find("const float PI") != std::string::npos);
+    T(stripped.find("UNUSED_A") != std::string::npos);
+    T(stripped.find("float helper(float x);") != std::string::npos);
+    T(stripped.find("float macro_only()") != std::string::npos);
+    T(stripped.find("float wave(float x)") != std::string::npos);
+    T(stripped.find("layout(location = 0) out vec4 color;") != std::string::npos);
+
+    // Compiler errors keep their line numbers
+    std::string original(source);
+    auto main_line = [](const std::string& text) {
+        return std::count(text.begin(), text.begin() + text.find("void main()"), '\n');
+    };
+    T(main_line(stripped) == main_line(original));
+
+    std::string unchanged;
+    T(!ShaderParserStripUnused(stripped, unchanged));
+}
+
+UTEST(shader_parser, instrument) {
+    std::string source =
+        "uniform sampler2D image;\n"
+        "out vec4 out_color;\n"
+        "// for (;;) texture(image, uv) in a comment\n"
+        "void main() {\n"
+        "    vec4 color = vec4(0.0);\n"
+        "    for (int i = 0; i < 4; ++i) {\n"
+        "        color += texture(image, vec2(texture(image, vec2(0.5)).r));\n"
+        "    }\n"
+        "    int j = 0;\n"
+        "    while (j < 2) ++j;\n"
+        "    do { ++j; } while (j < 8);\n"
+        "    out_color = color;\n"
+        "}\n";
+
+    std::string instrumented;
+    std::string error;
+    T(ShaderParserInstrument(source, instrumented, error));
+    T(error.empty());
+
+    T(instrumented.find("void live_glsl_main()") != std::string::npos);
+    T(instrumented.find("out vec4 out_color") == std::string::npos);
+    T(instrumented.find("vec4 out_color;") != std::string::npos);
+    T(instrumented.find("// for (;;) texture(image, uv) in a comment") != std::string::npos);
+    T(instrumented.find("live_glsl_fetch(texture(image, vec2(live_glsl_fetch(texture(image, vec2(0.5))).r)))") != std::string::npos);
+    T(instrumented.find("for (int i = 0; i < 4; ++i) { ++live_glsl_loop_count;") != std::string::npos);
+    T(instrumented.find("while (j < 2) { ++live_glsl_loop_count; ++j; }") != std::string::npos);
+    T(instrumented.find("do { ++live_glsl_loop_count; ++j; } while (j < 8);") != std::string::npos);
+    T(instrumented.find("out vec4 live_glsl_heat;") != std::string::npos);
+
+    // Layout qualifiers of outputs are dropped with them
+    std::string layout_source =
+        "layout(location = 0) out vec4 color;\n"
+        "layout(std140) uniform Block { vec4 tint; };\n"
+        "void main() { color = tint; }\n";
+    T(ShaderParserInstrument(layout_source, instrumented, error));
+    T(instrumented.find("location") == std::string::npos);
+    T(instrumented.find("vec4 color;") != std::string::npos);
+    T(instrumented.find("layout(std140) uniform Block") != std::string::npos);
+
+    T(!ShaderParserInstrument("void other() {}\n", instrumented, error));
+    T(!error.empty());
+}
+
+UTEST(render_pass, reuse_unchanged) {
+    std::vector<RenderPass> previous(2);
+    previous[0].ShaderSource = "void main() {}\n";
+    previous[0].Output = "buffer";
+    previous[0].Width = previous[0].Height = 64;
+    previous[0].Program.Handle = 1;
+    previous[0].TextureId = 2;
+    previous[0].FBO = 3;
+    previous[1].ShaderSource = "void main() { }\n";
+    previous[1].Output = "main";
+    previous[1].IsMain = true;
+    previous[1].Program.Handle = 4;
+    for (auto& render_pass : previous) {
+        render_pass.Hash = RenderPassHash(render_pass);
+    }
+
+    std::vector<RenderPass> render_passes(2);
+    render_passes[0] = previous[0];
+    render_passes[0].Program = ShaderProgram();
+    render_passes[0].TextureId = 0;
+    render_passes[0].FBO = 0;
+    render_passes[1] = previous[1];
+    render_passes[1].Program = ShaderProgram();
+    render_passes[1].ShaderSource = "void main() { discard; }\n";
+
+    // A different size is a different declaration
+    RenderPass resized = render_passes[0];
+    resized.Width = 128;
+    T(RenderPassHash(resized) != RenderPassHash(render_passes[0]));
+
+    RenderPassReuse(render_passes, previous);
+    T(render_passes[0].IsProgramReused);
+    T(render_passes[0].IsTargetReused);
+    T(render_passes[0].Program.Handle == 1);
+    T(render_passes[0].TextureId == 2);
+    T(render_passes[0].FBO == 3);
+    T(!render_passes[1].IsProgramReused);
+    T(render_passes[1].Program.Handle == 0);
+
+    RenderPassReleaseReused(render_passes);
+    T(render_passes[0].Program.Handle == 0);
+    T(render_passes[0].TextureId == 0);
+    T(render_passes[0].FBO == 0);
+}
+
+UTEST(shader_parser, freeze) {
+    std::vector<GUIComponent> components(2);
+    components[0].UniformName = "speed";
+    components[0].UniformType = EGUIUniformTypeFloat;
+    components[0].Data[0] = 2.0f;
+    components[1].UniformName = "tint";
+    components[1].UniformType = EGUIUniformTypeVec3;
+    components[1].Data[0] = 0.5f;
+    components[1].Data[1] = 0.25f;
+    components[1].Data[2] = 1.0f;
+
+    std::string source =
+        "uniform float time;\n"
+        "uniform float speed;\n"
+        "uniform vec3 tint;\n"
+        "void main() {}\n";
+
+    std::string frozen;
+    T(ShaderParserFreeze(source, components, frozen));
+    T(frozen ==
+        "uniform float time;\n"
+        "const float speed = float(2);\n"
+        "const vec3 tint = vec3(0.5, 0.25, 1);\n"
+        "void main() {}\n");
+
+    T(!ShaderParserFreeze("uniform vec2 speed;\nvoid main() {}\n", components, frozen));
+}
+
+UTEST(shader_parser, apply_defines) {
+    std::string error;
+    std::vector<GUIComponent> components(2);
+    T(GUIComponentParse(0, "toggle", "#define SOFT_SHADOWS", {}, components[0], error));
+    T(GUIComponentParse(0, "choice(8, 32, 64)", "#define STEPS 32", {}, components[1], error));
+
+    std::string source =
+        "#define SOFT_SHADOWS\n"
+        "  #define STEPS 32\n"
+        "void main() {}\n";
+
+    std::string applied;
+    T(ShaderParserApplyDefines(source, components, applied));
+    T(applied == source);
+
+    components[0].Data[0] = 0.0f;
+    components[1].Data[0] = 2.0f;
+    T(ShaderParserApplyDefines(source, components, applied));
+    T(applied ==
+        "\n"
+        "  #define STEPS 64\n"
+        "void main() {}\n");
+
+    T(!ShaderParserApplyDefines("#define OTHER 1\nvoid main() {}\n", components, applied));
+}
+
+UTEST(variant_cache, evicts_least_recently_used) {
+    HVariantCache cache = VariantCacheCreate(2);
+
+    // Programs without handles are enough to follow the entries
+    ShaderProgram program;
+    program.CacheKey = 1;
+    VariantCacheInsert(cache, 1, program);
+    program.CacheKey = 2;
+    VariantCacheInsert(cache, 2, program);
+
+    T(VariantCacheFind(cache, 1, program));
+    T(program.CacheKey == 1);
+
+    program.CacheKey = 3;
+    VariantCacheInsert(cache, 3, program);
+    T(VariantCacheSize(cache) == 2);
+    T(VariantCacheFind(cache, 1, program));
+    T(!VariantCacheFind(cache, 2, program));
+    T(VariantCacheFind(cache, 3, program));
+    T(program.CacheKey == 3);
+
+    VariantCacheDestroy(cache);
 }
 
 UTEST(utils, utils_split_string) {
@@ -329,4 +1273,158 @@ UTEST(utils, utils_extract_filename_without_ext) {
     T(ExtractFilenameWithoutExt("") == "");
 }
 
+UTEST(utils, utils_hash_fnv1a) {
+    // Reference values of the 64 bit FNV-1a hash
+    T(HashFNV1a("") == 0xcbf29ce484222325ull);
+    T(HashFNV1a("a") == 0xaf63dc4c8601ec8cull);
+    T(HashFNV1a("foobar") == 0x85944171f73967e8ull);
+    T(HashFNV1a("bar", HashFNV1a("foo")) == HashFNV1a("foobar"));
+}
+
+UTEST(utils, utils_create_directories) {
+    std::string path = "live_glsl_test_directory/nested/child";
+    T(CreateDirectories(path));
+    T(CreateDirectories(path));
+
+    std::ofstream file(path + "/file.txt");
+    T(file.is_open());
+    file.close();
+
+    remove((path + "/file.txt").c_str());
+    remove("live_glsl_test_directory/nested/child");
+    remove("live_glsl_test_directory/nested");
+    remove("live_glsl_test_directory");
+}
+
+UTEST(utils, utils_list_shader_files) {
+    T(CreateDirectories("live_glsl_test_corpus/nested"));
+    for (const char* path : {"live_glsl_test_corpus/b.frag", "live_glsl_test_corpus/nested/a.frag", "live_glsl_test_corpus/common.glsl"}) {
+        std::ofstream file(path);
+        file << "void main() {}" << std::endl;
+    }
+
+    std::vector<std::string> paths = ListShaderFiles("live_glsl_test_corpus");
+    T(paths.size() == 2);
+    T(paths[0] == "live_glsl_test_corpus/b.frag");
+    T(paths[1] == "live_glsl_test_corpus/nested/a.frag");
+
+    remove("live_glsl_test_corpus/b.frag");
+    remove("live_glsl_test_corpus/nested/a.frag");
+    remove("live_glsl_test_corpus/common.glsl");
+    remove("live_glsl_test_corpus/nested");
+    remove("live_glsl_test_corpus");
+
+    T(ListShaderFiles("live_glsl_test_corpus").empty());
+}
+
+UTEST(utils, utils_rename_file) {
+    std::string path = "live_glsl_test_rename.bin";
+    std::string temporary_path = TemporaryFilePath(path);
+    T(temporary_path != TemporaryFilePath(path));
+
+    for (const char* contents : {"first", "second"}) {
+        std::ofstream file(temporary_path);
+        file << contents;
+        file.close();
+        T(RenameFile(temporary_path, path));
+    }
+
+    std::ifstream file(path);
+    std::string contents;
+    file >> contents;
+    file.close();
+    T(contents == "second");
+    T(!std::ifstream(temporary_path).is_open());
+
+    remove(path.c_str());
+}
+
+UTEST(program_cache, load_truncated) {
+    ProgramCacheSetDirectory("live_glsl_test_program_cache");
+
+    // A header announcing far more bytes than the file holds
+    uint64_t key = 0x1234;
+    {
+        std::ofstream file("live_glsl_test_program_cache/0000000000001234.bin", std::ios::binary);
+        uint32_t version = 1;
+        uint32_t format = 0;
+        uint32_t length = 0xFFFFFFF0;
+        file.write("LGPB", 4);
+        file.write((const char*)&version, sizeof(version));
+        file.write((const char*)&key, sizeof(key));
+        file.write((const char*)&format, sizeof(format));
+        file.write((const char*)&length, sizeof(length));
+        file.write("binary", 6);
+    }
+
+    T(!ProgramCacheLoad(0, key));
+
+    ProgramCacheSetDirectory("");
+    remove("live_glsl_test_program_cache/0000000000001234.bin");
+    remove("live_glsl_test_program_cache");
+}
+
+UTEST(validator, write_report) {
+    std::vector<ValidatorResult> results(2);
+    results[0].Path = "a.frag";
+    results[0].Success = true;
+    results[0].RenderPasses = 1;
+    results[0].CompileMS = 1.5;
+    results[1].Path = "b.frag";
+    results[1].Error = "0:1(1): error: \"x\" undeclared\n";
+
+    FILE* file = tmpfile();
+    ValidatorWriteReport(results, file);
+    rewind(file);
+    char report[512] = {};
+    fread(report, 1, sizeof(report) - 1, file);
+    fclose(file);
+
+    TSTR(report,
+        "{\n"
+        "  \"total\": 2,\n"
+        "  \"failed\": 1,\n"
+        "  \"shaders\": [\n"
+        "    {\"path\": \"a.frag\", \"success\": true, \"passes\": 1, \"compile_ms\": 1.500},\n"
+        "    {\"path\": \"b.frag\", \"success\": false, \"passes\": 0, \"compile_ms\": 0.000, \"error\": \"0:1(1): error: \\\"x\\\" undeclared\\n\"}\n"
+        "  ]\n"
+        "}\n");
+}
+
+UTEST(playlist, load_list) {
+    T(CreateDirectories("live_glsl_test_playlist"));
+    {
+        std::ofstream file("live_glsl_test_playlist/list.txt");
+        file << "# opening" << std::endl;
+        file << "intro.frag" << std::endl;
+        file << std::endl;
+        file << "  /shaders/outro.frag  " << std::endl;
+    }
+
+    std::vector<PlaylistEntry> entries;
+    std::string error;
+    T(PlaylistLoad("live_glsl_test_playlist/list.txt", entries, error));
+    T(entries.size() == 2);
+    TSTR(entries[0].Path.c_str(), "live_glsl_test_playlist/intro.frag");
+    TSTR(entries[1].Path.c_str(), "/shaders/outro.frag");
+
+    remove("live_glsl_test_playlist/list.txt");
+    remove("live_glsl_test_playlist");
+
+    T(!PlaylistLoad("live_glsl_test_playlist/list.txt", entries, error));
+    TSTR(error.c_str(), "Playlist not found: live_glsl_test_playlist/list.txt");
+}
+
+UTEST(playlist, near_entries) {
+    T(PlaylistNext(0, -1, 5) == 4);
+    T(PlaylistNext(4, 1, 5) == 0);
+    T(PlaylistNext(2, 7, 5) == 4);
+
+    std::vector<uint32_t> near = PlaylistNearEntries(0, 5);
+    T(near == std::vector<uint32_t>({0, 1, 4, 2}));
+
+    near = PlaylistNearEntries(1, 2);
+    T(near == std::vector<uint32_t>({1, 0}));
+}
+
 UTEST_MAIN();